@@ -23,6 +23,12 @@
 #include <vector>
 #include <stdlib.h>
 
+#include "../../common/synapse_groups.h"
+#include "../../common/timestep_grouping.h"
+#include "../../common/trace.h"
+
+using namespace SNNBench;
+
 void connect_with_sparsity(
     int input_layer,
     int output_layer,
@@ -32,6 +38,7 @@ void connect_with_sparsity(
     float sparseness,
     SpikingModel* Model
     ){
+  Trace::Scope trace("Random connectivity", "loader");
   // Change the connectivity type
   int num_post_neurons = 
     output_layer_params->group_shape[0]*output_layer_params->group_shape[1];
@@ -55,6 +62,31 @@ void connect_with_sparsity(
   Model->AddSynapseGroup(input_layer, output_layer, SYN_PARAMS);
 
 }
+// Connect input neuron offset + i to neuron i of output_layer
+void connect_one_to_one(
+    int input_layer,
+    int output_layer,
+    int offset,
+    spiking_neuron_parameters_struct* output_layer_params,
+    voltage_spiking_synapse_parameters_struct* SYN_PARAMS,
+    SpikingModel* Model
+    ){
+  Trace::Scope trace("One-to-one connectivity", "loader");
+  int num_post_neurons =
+    output_layer_params->group_shape[0]*output_layer_params->group_shape[1];
+
+  std::vector<int> prevec, postvec;
+  for (int outid = 0; outid < num_post_neurons; outid++){
+    prevec.push_back(offset + outid);
+    postvec.push_back(outid);
+  }
+
+  SYN_PARAMS->pairwise_connect_presynaptic = prevec;
+  SYN_PARAMS->pairwise_connect_postsynaptic = postvec;
+  SYN_PARAMS->connectivity_type = CONNECTIVITY_TYPE_PAIRWISE;
+
+  Model->AddSynapseGroup(input_layer, output_layer, SYN_PARAMS);
+}
 int connect_from_mat(
     int layer1,
     int layer2,
@@ -63,6 +95,7 @@ int connect_from_mat(
     SpikingModel* Model,
     float timestep,
     int numskipgroups=1){
+  Trace::Scope trace("Load connectivity", "loader");
   int synapse_group_index = -1;
 
   ifstream weightfile;
@@ -119,15 +152,29 @@ int main (int argc, char *argv[]){
   float sparseness = 0.1;
   bool fast = false;
   bool no_TG = false;
+  bool tune_TG = false;
+  float tune_burst = 0.2f;
   bool plastic = false;
+  bool aggregated_poisson = false;
   int numsyngroups = 1;
+  bool recalibrate = false;
+  float calibration_simtime = 2.0f;
+  int trace_every = 0;
   const char* const short_opts = "";
   const option long_opts[] = {
     {"simtime", 1, nullptr, 0},
     {"fast", 0, nullptr, 1},
     {"plastic", 0, nullptr, 4},
     {"NOTG", 0, nullptr, 5},
-    {"num_synapse_groups", 1, nullptr, 6}
+    {"num_synapse_groups", 1, nullptr, 6},
+    {"trace", 0, nullptr, 7},
+    {"trace_every", 1, nullptr, 8},
+    {"aggregated_poisson", 0, nullptr, 9},
+    {"tune_TG", 0, nullptr, 10},
+    {"tune_burst", 1, nullptr, 11},
+    {"recalibrate", 0, nullptr, 12},
+    {"calibration_simtime", 1, nullptr, 13},
+    {nullptr, 0, nullptr, 0}
   };
   // Check the set of options
   while (true) {
@@ -155,7 +202,36 @@ int main (int argc, char *argv[]){
         break;
       case 6:
         printf("Number of synapse groups; %s\n", optarg);
-        numsyngroups = std::stoi(optarg);
+        numsyngroups = (std::string(optarg) == "auto") ? 0 : std::stoi(optarg);
+        break;
+      case 7:
+        printf("Writing a chrome://tracing timeline to trace.json\n");
+        Trace::enable();
+        break;
+      case 8:
+        printf("Tracing every %s simulation steps\n", optarg);
+        trace_every = std::stoi(optarg);
+        Trace::enable();
+        break;
+      case 9:
+        printf("Aggregating the Poisson input into one input neuron per target\n");
+        aggregated_poisson = true;
+        break;
+      case 10:
+        printf("Tuning timestep grouping before the run\n");
+        tune_TG = true;
+        break;
+      case 11:
+        printf("Calibrating timestep grouping with %ss bursts\n", optarg);
+        tune_burst = std::stof(optarg);
+        break;
+      case 12:
+        printf("Ignoring any cached number of synapse groups\n");
+        recalibrate = true;
+        break;
+      case 13:
+        printf("Calibrating synapse groups with %ss runs\n", optarg);
+        calibration_simtime = std::stof(optarg);
         break;
     }
   };
@@ -167,6 +243,36 @@ int main (int argc, char *argv[]){
   BenchModel->SetTimestep(timestep);
   float delayval = 1.5f*powf(10.0, -3.0); // 1.5ms
 
+  // With --num_synapse_groups auto, time each split count of EE in a short
+  // child run of this benchmark, unless this machine already chose one for
+  // the same connectivity and configuration
+  if (numsyngroups == 0){
+    Trace::Scope calibration("Calibrate synapse groups");
+    const std::string cachefile = "synapse_groups.cache";
+    std::string config = std::string(plastic ? "plastic" : "static") + (aggregated_poisson ? "_aggregated" : "") + (no_TG ? "_NOTG" : "");
+    std::string key = SynapseGroups::getConnectivityHash("../../ee.wmat") + ":" + config;
+    if (!recalibrate)
+      numsyngroups = SynapseGroups::readCache(cachefile, key);
+    if (numsyngroups > 0){
+      printf("Using %d synapse group(s) cached in %s for %s\n", numsyngroups, cachefile.c_str(), key.c_str());
+    } else {
+      std::string command = std::string(argv[0]) + " --fast --simtime " + std::to_string(calibration_simtime);
+      if (plastic) command += " --plastic";
+      if (aggregated_poisson) command += " --aggregated_poisson";
+      if (no_TG) command += " --NOTG";
+      const unsigned int delay_steps = (unsigned int)roundf(delayval / timestep);
+      const unsigned int calibration_steps = (unsigned int)roundf(calibration_simtime / timestep);
+      numsyngroups = SynapseGroups::calibrate(command,
+          SynapseGroups::getSplits("../../ee.wmat", delay_steps, SynapseGroups::getCandidates(delay_steps)),
+          calibration_steps);
+      if (numsyngroups == 0){
+        printf("Synapse group calibration failed\n");
+        exit(-1);
+      }
+      SynapseGroups::writeCache(cachefile, key, numsyngroups);
+    }
+  }
+
   // Create neuron, synapse and stdp types for this model
   LIFSpikingNeurons * lif_spiking_neurons = new LIFSpikingNeurons();
   PoissonInputSpikingNeurons * poisson_input_spiking_neurons = new PoissonInputSpikingNeurons();
@@ -234,6 +340,18 @@ int main (int argc, char *argv[]){
   input_neuron_params->group_shape[0] = 1;    // x-dimension of the input neuron layer
   input_neuron_params->group_shape[1] = 10000;    // y-dimension of the input neuron layer
   input_neuron_params->rate = 20.0f; // Hz
+
+  // Each neuron receives Binomial(in_degree, rate * timestep) input spikes per
+  // step. Spike's input neurons spike at most once per step, so the aggregated
+  // input gives every neuron a single input neuron whose rate and weight
+  // match the mean and variance of that drive, replacing 10^7 synapses by 10^4
+  const int input_in_degree = (int)(sparseness * input_neuron_params->group_shape[1]);
+  const double input_p = input_neuron_params->rate * timestep;
+  const double input_mean = input_in_degree * input_p;
+  const double input_var = input_mean * (1.0 - input_p);
+  const float aggregated_weight_scale = (float)((input_var / input_mean) + input_mean);
+  if (aggregated_poisson)
+    input_neuron_params->rate = (float)((input_mean * input_mean) / (input_var + (input_mean * input_mean)) / timestep);
   int input_layer_ID = BenchModel->AddInputNeuronGroup(input_neuron_params);
   poisson_input_spiking_neurons->set_up_rates();
 
@@ -275,6 +393,10 @@ int main (int argc, char *argv[]){
   */
   INPUT_SYN_PARAMS->weight_range[0] = weight_val;
   INPUT_SYN_PARAMS->weight_range[1] = weight_val;
+  if (aggregated_poisson){
+    INPUT_SYN_PARAMS->weight_range[0] = aggregated_weight_scale * weight_val;
+    INPUT_SYN_PARAMS->weight_range[1] = aggregated_weight_scale * weight_val;
+  }
 
   // Biological Scaling factors (ensures that voltage is in mV)
   float weight_multiplier = 1.0f; //powf(10.0, -3.0);
@@ -302,16 +424,28 @@ int main (int argc, char *argv[]){
     BenchModel,
     timestep);
 
-  connect_with_sparsity(
-      input_layer_ID, EXCITATORY_NEURONS[0],
-      input_neuron_params, EXC_NEURON_PARAMS,
-      INPUT_SYN_PARAMS, sparseness,
-      BenchModel);
-  connect_with_sparsity(
-      input_layer_ID, INHIBITORY_NEURONS[0],
-      input_neuron_params, INH_NEURON_PARAMS,
-      INPUT_SYN_PARAMS, sparseness,
-      BenchModel);
+  if (aggregated_poisson){
+    // Input neurons [0, 8000) drive E and [8000, 10000) drive I
+    connect_one_to_one(
+        input_layer_ID, EXCITATORY_NEURONS[0], 0,
+        EXC_NEURON_PARAMS, INPUT_SYN_PARAMS,
+        BenchModel);
+    connect_one_to_one(
+        input_layer_ID, INHIBITORY_NEURONS[0], EXC_NEURON_PARAMS->group_shape[1],
+        INH_NEURON_PARAMS, INPUT_SYN_PARAMS,
+        BenchModel);
+  } else {
+    connect_with_sparsity(
+        input_layer_ID, EXCITATORY_NEURONS[0],
+        input_neuron_params, EXC_NEURON_PARAMS,
+        INPUT_SYN_PARAMS, sparseness,
+        BenchModel);
+    connect_with_sparsity(
+        input_layer_ID, INHIBITORY_NEURONS[0],
+        input_neuron_params, INH_NEURON_PARAMS,
+        INPUT_SYN_PARAMS, sparseness,
+        BenchModel);
+  }
 
   if (plastic)
     EXC_OUT_SYN_PARAMS->plasticity_vec.push_back(weightdependent_stdp);
@@ -365,12 +499,24 @@ int main (int argc, char *argv[]){
   /*
     COMPLETE NETWORK SETUP
   */
-  BenchModel->finalise_model();
+  {
+    Trace::Scope finalise("Finalise model");
+    BenchModel->finalise_model();
+  }
   if (no_TG)
     BenchModel->timestep_grouping = 1;
+  else if (tune_TG && plastic)
+    // Calibration bursts would run STDP on the weights, which reset_state isn't known to restore
+    printf("Not tuning timestep grouping with plasticity ON\n");
+  else if (tune_TG)
+    TimestepGrouping::tune(BenchModel, tune_burst);
+  printf("Running with timestep grouping: %d\n", BenchModel->timestep_grouping);
 
   clock_t starttime = clock();
-  BenchModel->run(simtime);
+  {
+    Trace::Scope run("Simulation", "simulation");
+    Trace::runModel(BenchModel, simtime, timestep, trace_every);
+  }
   clock_t totaltime = clock() - starttime;
   if ( fast ){
     std::ofstream timefile;
@@ -380,6 +526,7 @@ int main (int argc, char *argv[]){
     timefile.close();
   }
   // Dump the weights if we are running in plasticity mode
+  Trace::Scope output("Output", "output");
   if (plastic)
     BenchModel->spiking_synapses->save_connectivity_as_binary("./", "BRUNELPLASTIC_", ee_syns);
   if (!fast){
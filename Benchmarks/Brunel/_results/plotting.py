@@ -1,3 +1,4 @@
+import os
 import matplotlib.pyplot as plt
 import numpy as np
 #plt.style.use('ggplot')
@@ -10,6 +11,7 @@ simulators = [
         "Brian2",
         "ANNarchy",
         "NEST",
+        "Native",
         ]
 
 
@@ -18,6 +20,11 @@ non_plastic_foldername = "simulation_speed/non_plastic/"
 plastic_speedresults = []
 plastic_foldername = "simulation_speed/plastic/"
 
+# Simulators without results for both configurations (e.g. the native
+# engine until it has been benchmarked) are left out of the plot
+simulators = [s for s in simulators
+              if os.path.exists(non_plastic_foldername+s+".dat") and os.path.exists(plastic_foldername+s+".dat")]
+
 for s in simulators:
     with open(non_plastic_foldername+s+".dat", 'r') as f:
         time = f.read()
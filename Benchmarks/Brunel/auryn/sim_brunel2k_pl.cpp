@@ -58,6 +58,7 @@ int main(int ac,char *av[]) {
   double wext = 0.1e-3; 
   double sparseness = 0.1;
   double simtime = 0.;
+  int networkscale = 1;
 
   double lambda = 1e-2; 
   // For the benchmark this value was changed to 1e-9 to 
@@ -86,6 +87,7 @@ int main(int ac,char *av[]) {
       desc.add_options()
           ("help", "produce help message")
           ("simtime", po::value<double>(), "duration of simulation")
+          ("networkscale", po::value<int>(), "Network Scale, relative to 10000 Neurons")
           ("fast", "turns off most monitoring to reduce IO")
           ("plastic", "turns on STDP")
           ("gamma", po::value<double>(), "gamma factor for inhibitory weight")
@@ -113,6 +115,11 @@ int main(int ac,char *av[]) {
         simtime = vm["simtime"].as<double>();
       } 
 
+      if (vm.count("networkscale")) {
+        networkscale = vm["networkscale"].as<int>();
+        printf("Multiplying the Network Size (and dividing connectivity) by; %d\n", networkscale);
+      } 
+
       if (vm.count("gamma")) {
         gamma = vm["gamma"].as<double>();
       } 
@@ -167,6 +174,15 @@ int main(int ac,char *av[]) {
       std::cerr << "Exception of unknown type!\n";
     }
 
+  // Adjusting the sparseness and neuron number based upon scale
+  // (connectivity files only exist for the unscaled network)
+  sparseness /= (double)networkscale;
+  ne *= networkscale;
+  ni *= networkscale;
+  if (networkscale != 1) {
+    fwmat_ee = fwmat_ei = fwmat_ie = fwmat_ii = "";
+  }
+
   auryn_init(ac, av);
   oss << dir  << "/brunel." << sys->mpi_rank() << ".";
   string outputfile = oss.str();
@@ -235,7 +251,7 @@ int main(int ac,char *av[]) {
     con_ee_stdp->set_alpha(2.02);
     con_ee_stdp->set_lambda(lambda); 
     con_ee_stdp->sanity_check();
-    con_ee_stdp->load_from_complete_file("../ee.wmat");
+    if (networkscale == 1) con_ee_stdp->load_from_complete_file("../ee.wmat");
     //if ( !fwmat_ee.empty() ) con_ee_stdp->load_from_complete_file(fwmat_ee);
   } else {
     SparseConnection * con_ee;
@@ -268,9 +284,11 @@ int main(int ac,char *av[]) {
     filename.clear();
     filename << outputfile << "i.ras";
     SpikeMonitor * smon_i = new SpikeMonitor( neurons_i, filename.str().c_str(), nrec);
-    RateChecker * chk = new RateChecker( neurons_e , 0.1 , 1000. , 100e-3);
   }
 
+  // Abort runs whose excitatory rate leaves [0.1, 1000]Hz, in fast mode too
+  RateChecker * chk = new RateChecker( neurons_e , 0.1 , 1000. , 100e-3);
+
   // filename.str("");
   // filename.clear();
   // filename << outputfile << "syn";
@@ -307,13 +325,22 @@ int main(int ac,char *av[]) {
       errcode = 1;
   clock_t totaltime = clock() - starttime;
 
-  if ( fast ){
+  if ( fast && sys->mpi_rank() == 0 ){
     std::ofstream timefile;
     timefile.open("timefile.dat");
     timefile << std::setprecision(10) << ((float)totaltime / CLOCKS_PER_SEC);
     timefile.close();
   }
 
+  if ( sys->mpi_rank() == 0 ) {
+    logger->msg("Saving elapsed time ..." ,PROGRESS,true);
+    char filenamebuf [255];
+    sprintf(filenamebuf, "%s/elapsed.dat", dir.c_str());
+    std::ofstream timefile;
+    timefile.open(filenamebuf);
+    timefile << sys->get_last_elapsed_time() << std::endl;
+    timefile.close();
+  }
 
 
   if ( !save.empty() & !fast ) {
@@ -1,11 +1,53 @@
 # GeNN has a two stage compilation process
 # You must ensure that GeNN has been installed correctly
 
+# The neurons use forward Euler unless built with INTEGRATOR=exact
+# (e.g. INTEGRATOR=exact ./compile.sh), which uses the exact propagator
+if [ "${INTEGRATOR:-euler}" = "exact" ]; then
+  export CXXFLAGS="$CXXFLAGS -DEXACT_INTEGRATION=1"
+fi
+
+# External drive comes from 10,000 Poisson neurons unless built with
+# POISSON_INPUT=aggregated, which draws each neuron's input spike count
+# per step from a binomial distribution instead (as Auryn does)
+if [ "${POISSON_INPUT:-neurons}" = "aggregated" ]; then
+  export CXXFLAGS="$CXXFLAGS -DAGGREGATED_POISSON=1"
+fi
+
+# STDP trace decays are computed with exp unless built with STDP_DECAY=table,
+# which looks them up by the number of timesteps elapsed
+if [ "${STDP_DECAY:-exp}" = "table" ]; then
+  export CXXFLAGS="$CXXFLAGS -DSTDP_DECAY_TABLE=1"
+fi
+
+# STDP traces are held in every E->E synapse unless built with
+# STDP_TRACES=neuron, which holds them once per neuron (exp decays only)
+if [ "${STDP_TRACES:-synapse}" = "neuron" ]; then
+  export CXXFLAGS="$CXXFLAGS -DNEURON_STDP_TRACES=1"
+fi
+
+# Both a plastic and a static E->E projection are built, and --plastic picks
+# one at run time, unless built with EE_PROJECTION=plastic or static, which
+# leaves the other out (the unused STDP projection still costs memory and
+# kernel launches in a static run)
+if [ "${EE_PROJECTION:-both}" = "plastic" ]; then
+  export CXXFLAGS="$CXXFLAGS -DEE_STATIC_PROJECTION=0"
+elif [ "${EE_PROJECTION:-both}" = "static" ]; then
+  export CXXFLAGS="$CXXFLAGS -DEE_PLASTIC_PROJECTION=0"
+fi
+
+# Weight snapshots (--weight_every) are written on a background thread
+export CXXFLAGS="$CXXFLAGS -pthread"
+
 # First, allow the code generation;
 genn-buildmodel.sh model.cc 
 
-# Finally compile the example
-make -j8
+# Finally compile the example (forcing a rebuild as the build options may have changed)
+make -B -j8
 
 # In order to run the model;
 # ./simulator --simtime 100.0 --fast
+# or, with STDP on the E->E synapses;
+# ./simulator --simtime 100.0 --fast --plastic
+# and with a snapshot of the E->E weights every 100ms in weight_stream.bin;
+# ./simulator --simtime 100.0 --fast --plastic --weight_every 100 --weight_encoding delta
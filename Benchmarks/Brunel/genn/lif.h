@@ -48,6 +48,111 @@ public:
     SET_VARS({{"V", "scalar"}, {"RefracTime", "scalar"}});
 };
 IMPLEMENT_MODEL(LIF);
+
+//----------------------------------------------------------------------------
+// BoBRobotics::GeNNModels::LIFExact
+//----------------------------------------------------------------------------
+//! Leaky integrate-and-fire neuron integrated with the exact propagator
+//! ExpTC, the delta current input being added after the decay
+class LIFExact : public NeuronModels::Base
+{
+public:
+    DECLARE_MODEL(LIFExact, 7, 2);
+
+    SET_SIM_CODE(
+        "if ($(RefracTime) <= 0.0)\n"
+        "{\n"
+        "  scalar alpha = $(Vrest) + $(Ioffset);\n"
+        "  $(V) = alpha - ($(ExpTC) * (alpha - $(V))) + $(Isyn);\n"
+        "}\n"
+        "else\n"
+        "{\n"
+        "  $(RefracTime) -= DT;\n"
+        "}\n"
+    );
+
+    SET_THRESHOLD_CONDITION_CODE("$(RefracTime) <= 0.0 && $(V) >= $(Vthresh)");
+
+    SET_RESET_CODE(
+        "$(V) = $(Vreset);\n"
+        "$(RefracTime) = $(TauRefrac);\n");
+
+    SET_PARAM_NAMES({
+        "C",          // Membrane capacitance
+        "TauM",       // Membrane time constant [ms]
+        "Vrest",      // Resting membrane potential [mV]
+        "Vreset",     // Reset voltage [mV]
+        "Vthresh",    // Spiking threshold [mV]
+        "Ioffset",    // Offset current
+        "TauRefrac"});
+
+    SET_DERIVED_PARAMS({
+        {"ExpTC", [](const vector<double> &pars, double dt){ return std::exp(-dt / pars[1]); }},
+        {"Rmembrane", [](const vector<double> &pars, double){ return  pars[1] / pars[0]; }}});
+
+    SET_VARS({{"V", "scalar"}, {"RefracTime", "scalar"}});
+};
+IMPLEMENT_MODEL(LIFExact);
+
+//----------------------------------------------------------------------------
+// BoBRobotics::GeNNModels::BinomialInput
+//----------------------------------------------------------------------------
+//! LIF (or LIFExact) neuron which also receives the spikes of an aggregated
+//! population of Poisson neurons, as Auryn's PoissonStimulator does. Each
+//! step the number of input spikes is drawn from Binomial(PoissonInDegree,
+//! PoissonRate * DT) by inverting its CDF (about PoissonInDegree *
+//! PoissonRate * DT + 1 iterations) and added to the delta current input
+//! weighted by PoissonWeight
+template<typename LIFModel>
+class BinomialInput : public LIFModel
+{
+public:
+    DECLARE_MODEL(BinomialInput, 10, 2);
+
+    virtual std::string getSimCode() const override
+    {
+        const std::string draw =
+            "unsigned int poissonSpikes = 0;\n"
+            "{\n"
+            "  scalar u = $(gennrand_uniform);\n"
+            "  scalar pmf = $(PoissonPmf0);\n"
+            "  while(u > pmf && poissonSpikes < (unsigned int)$(PoissonInDegree))\n"
+            "  {\n"
+            "    u -= pmf;\n"
+            "    pmf *= $(PoissonOdds) * ($(PoissonInDegree) - poissonSpikes) / (poissonSpikes + 1);\n"
+            "    poissonSpikes++;\n"
+            "  }\n"
+            "}\n";
+
+        // Add the Poisson input wherever the underlying model uses its synaptic input
+        std::string code = LIFModel::getSimCode();
+        const std::string isyn = "$(Isyn)";
+        const std::string isynWithPoisson = "($(Isyn) + (poissonSpikes * $(PoissonWeight)))";
+        for(size_t pos = code.find(isyn); pos != std::string::npos; pos = code.find(isyn, pos + isynWithPoisson.size())) {
+            code.replace(pos, isyn.size(), isynWithPoisson);
+        }
+        return draw + code;
+    }
+
+    virtual NeuronModels::Base::StringVec getParamNames() const override
+    {
+        NeuronModels::Base::StringVec paramNames = LIFModel::getParamNames();
+        paramNames.push_back("PoissonInDegree");  // Number of Poisson neurons targeting each neuron
+        paramNames.push_back("PoissonRate");      // Their firing rate [Hz]
+        paramNames.push_back("PoissonWeight");    // Their weight [mV]
+        return paramNames;
+    }
+
+    virtual NeuronModels::Base::DerivedParamVec getDerivedParams() const override
+    {
+        NeuronModels::Base::DerivedParamVec derivedParams = LIFModel::getDerivedParams();
+        derivedParams.push_back({"PoissonPmf0", [](const vector<double> &pars, double dt){ return std::pow(1.0 - (pars[8] * dt / 1000.0), pars[7]); }});
+        derivedParams.push_back({"PoissonOdds", [](const vector<double> &pars, double dt){ return (pars[8] * dt / 1000.0) / (1.0 - (pars[8] * dt / 1000.0)); }});
+        return derivedParams;
+    }
+};
+template<typename LIFModel>
+BinomialInput<LIFModel> *BinomialInput<LIFModel>::s_Instance = NULL;
 } // GeNNModels
 } // BoBRobotics
 
@@ -7,6 +7,8 @@
 
 #include "sparseProjection.h"
 
+#include "../../common/trace.h"
+
 void reset_array(
     float* array,
     unsigned int num_elements)
@@ -24,6 +26,7 @@ void random_connectivity(
     unsigned int numSyns,
     int seed)
 {
+  SNNBench::Trace::Scope trace("Random connectivity", "loader");
 
   srand(seed);
   for (int preid = 0; preid < numPre; preid++){
@@ -41,6 +44,7 @@ void ragged_connectivity_from_mat(
     unsigned int numPre,
     unsigned int maxRows)
 {
+  SNNBench::Trace::Scope trace("Load connectivity", "loader");
 
   ifstream weightfile;
   string line;
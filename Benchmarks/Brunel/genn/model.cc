@@ -12,6 +12,29 @@
 
 #include "parameters.h"
 
+// Shared benchmark utilities
+#include "../../common/decay_table.h"
+
+#if EXACT_INTEGRATION
+typedef BoBRobotics::GeNNModels::LIFExact LIFModel;
+#else
+typedef BoBRobotics::GeNNModels::LIF LIFModel;
+#endif
+
+#if STDP_DECAY_TABLE
+typedef STDPWeightDependentTable STDPModel;
+#elif NEURON_STDP_TRACES
+typedef STDPWeightDependentNeuronTraces STDPModel;
+#else
+typedef STDPWeightDependent STDPModel;
+#endif
+
+#if AGGREGATED_POISSON
+typedef BoBRobotics::GeNNModels::BinomialInput<LIFModel> NeuronModel;
+#else
+typedef LIFModel NeuronModel;
+#endif
+
 void modelDefinition(NNmodel &model)
 {
     initGeNN();
@@ -29,20 +52,27 @@ void modelDefinition(NNmodel &model)
         Parameters::thresholdVoltage);  // 1 - max
 
     // LIF model parameters
-    BoBRobotics::GeNNModels::LIF::ParamValues lifParams(
+    NeuronModel::ParamValues lifParams(
         200.0e-9,    // 0 - C
         20.0,   // 1 - TauM
         Parameters::restVoltage,  // 2 - Vrest
         Parameters::resetVoltage,  // 3 - Vreset
         Parameters::thresholdVoltage,  // 4 - Vthresh
         0.0,    // 5 - Ioffset
-        0.0);    // 6 - TauRefrac
+        0.0    // 6 - TauRefrac
+#if AGGREGATED_POISSON
+        , Parameters::poissonInDegree,  // 7 - PoissonInDegree
+        Parameters::poissonRate,        // 8 - PoissonRate
+        Parameters::excitatoryWeight    // 9 - PoissonWeight
+#endif
+        );
 
     // LIF initial conditions
-    BoBRobotics::GeNNModels::LIF::VarValues lifInit(
+    NeuronModel::VarValues lifInit(
         Parameters::restVoltage, //initVar<InitVarSnippet::Uniform>(vDist),     // 0 - V
         0.0);   // 1 - RefracTime
 
+#if !AGGREGATED_POISSON
     NeuronModels::PoissonNew::VarValues poisInit(
         0.0f // 0 - Membrane Voltage
         );
@@ -50,34 +80,54 @@ void modelDefinition(NNmodel &model)
         //100.0 // 2 - Last Spike Time of Neuron
         //);
     NeuronModels::PoissonNew::ParamValues poisParams(
-        20.0f // 0 - Firing Rate
+        Parameters::poissonRate // 0 - Firing Rate
         );
         //0.0f, // 1 - Refractory Period
         //20.0, // 2 - Threshold Voltage for Spike
         //0.0 // 3 - Rest Voltage
         //);
     auto *poisson = model.addNeuronPopulation<NeuronModels::PoissonNew>("P", Parameters::numPoisson, poisParams, poisInit);
+#endif
 
     // Create IF_curr neuron
-    auto *e = model.addNeuronPopulation<BoBRobotics::GeNNModels::LIF>("E", Parameters::numExcitatory, lifParams, lifInit);
-    auto *i = model.addNeuronPopulation<BoBRobotics::GeNNModels::LIF>("I", Parameters::numInhibitory, lifParams, lifInit);
+    auto *e = model.addNeuronPopulation<NeuronModel>("E", Parameters::numExcitatory, lifParams, lifInit);
+    auto *i = model.addNeuronPopulation<NeuronModel>("I", Parameters::numInhibitory, lifParams, lifInit);
 
-    STDPWeightDependent::VarValues stdp_ini(
+#if NEURON_STDP_TRACES
+    STDPModel::VarValues stdp_ini(
+          Parameters::excitatoryWeight // 0 - g: the synaptic conductance value
+    );
+    STDPModel::PreVarValues stdp_pre_ini(
+          0.0, // pretrace
+          0.0  // t_preupdate
+    );
+    STDPModel::PostVarValues stdp_post_ini(
+          0.0, // posttrace
+          0.0  // t_postupdate
+    );
+#else
+    STDPModel::VarValues stdp_ini(
           Parameters::excitatoryWeight, // 0 - g: the synaptic conductance value
           0.0, // pretrace
           0.0, // t_preupdate
           0.0, // posttrace
           0.0  // t_postupdate
     );
-    STDPWeightDependent::ParamValues stdp_params(
-      20.0,  // 0 - Potentiation time constant (ms)
-      20.0, // 1 - Depression time constant (ms)
+#endif
+    STDPModel::ParamValues stdp_params(
+      Parameters::tauPlus,  // 0 - Potentiation time constant (ms)
+      Parameters::tauMinus, // 1 - Depression time constant (ms)
       1.0,    // 2 - Rate of potentiation
       1.0,   // 3 - Rate of depression
-      0.0,     // 4 - Minimum weight
-      3.0f*Parameters::excitatoryWeight,     // 5 - Maximum weight
+      Parameters::stdpWeightMin,     // 4 - Minimum weight
+      Parameters::stdpWeightMax,     // 5 - Maximum weight
       0.01,   // 6 - Learning Rate
       2.02    // 7 - Relative Weighting (LTD to LTP)
+#if STDP_DECAY_TABLE
+      , SNNBench::DecayTable::DefaultLength // 8 - Entries in each decay table
+#elif NEURON_STDP_TRACES
+      , (Parameters::synapticDelay + 1) * Parameters::timestep // 8 - Spike arrival delay (ms)
+#endif
     );
 
     
@@ -98,6 +148,7 @@ void modelDefinition(NNmodel &model)
         */
 
     int DELAY = Parameters::synapticDelay; // In timesteps
+#if !AGGREGATED_POISSON
     auto *pe = model.addSynapsePopulation<WeightUpdateModels::StaticPulse, PostsynapticModels::DeltaCurr>(
         "PE", SynapseMatrixType::RAGGED_INDIVIDUALG, DELAY,
         "P", "E",
@@ -112,15 +163,31 @@ void modelDefinition(NNmodel &model)
         {},
         {});
     pi->setMaxConnections(Parameters::probabilityConnection*Parameters::numInhibitory);
+#endif
 
-    auto *ee = model.addSynapsePopulation<STDPWeightDependent, PostsynapticModels::DeltaCurr>(
-    //auto *ee = model.addSynapsePopulation<WeightUpdateModels::StaticPulse, PostsynapticModels::DeltaCurr>( // Uncomment for no STDP
+    // Unless EE_PROJECTION picks one, both a plastic and a static E->E
+    // projection are generated and the simulator loads the connectivity into
+    // the one chosen with --plastic, leaving the other without synapses
+#if EE_PLASTIC_PROJECTION
+    auto *ee = model.addSynapsePopulation<STDPModel, PostsynapticModels::DeltaCurr>(
         "EE", SynapseMatrixType::RAGGED_INDIVIDUALG, DELAY,
         "E", "E",
         stdp_params, stdp_ini,
-        //{}, excs_ini, //Uncomment for no STDP
+#if NEURON_STDP_TRACES
+        stdp_pre_ini, stdp_post_ini,
+#endif
         {}, {});
     ee->setMaxConnections(Parameters::EEMaxRow);
+#endif
+
+#if EE_STATIC_PROJECTION
+    auto *eeStatic = model.addSynapsePopulation<WeightUpdateModels::StaticPulse, PostsynapticModels::DeltaCurr>(
+        "EEStatic", SynapseMatrixType::RAGGED_INDIVIDUALG, DELAY,
+        "E", "E",
+        {}, excs_ini,
+        {}, {});
+    eeStatic->setMaxConnections(Parameters::EEMaxRow);
+#endif
 
     auto *ei = model.addSynapsePopulation<WeightUpdateModels::StaticPulse, PostsynapticModels::DeltaCurr>(
         "EI", SynapseMatrixType::RAGGED_INDIVIDUALG, DELAY,
@@ -145,7 +212,9 @@ void modelDefinition(NNmodel &model)
 
 
     // Configure spike variables so that they can be downloaded to host
+#if !AGGREGATED_POISSON
     poisson->setSpikeVarMode(VarMode::LOC_HOST_DEVICE_INIT_DEVICE);
+#endif
     e->setSpikeVarMode(VarMode::LOC_HOST_DEVICE_INIT_DEVICE);
     i->setSpikeVarMode(VarMode::LOC_HOST_DEVICE_INIT_DEVICE);
 
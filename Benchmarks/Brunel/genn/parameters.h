@@ -3,6 +3,51 @@
 // Standard C includes
 #include <cmath>
 
+// Neuron integrator, chosen when building the model: LIF's forward Euler by
+// default or, with "INTEGRATOR=exact ./compile.sh", LIFExact's exact propagator
+#ifndef EXACT_INTEGRATION
+#define EXACT_INTEGRATION 0
+#endif
+
+// External drive, chosen when building the model: 10,000 PoissonNew neurons
+// and their PE/PI synapses by default or, with
+// "POISSON_INPUT=aggregated ./compile.sh", a binomial draw per LIF neuron
+#ifndef AGGREGATED_POISSON
+#define AGGREGATED_POISSON 0
+#endif
+
+// STDP trace decay, chosen when building the model: exp in every synapse
+// update by default or, with "STDP_DECAY=table ./compile.sh", a lookup
+// indexed by the timesteps since the trace was last updated
+#ifndef STDP_DECAY_TABLE
+#define STDP_DECAY_TABLE 0
+#endif
+
+// Where STDP traces are held, chosen when building the model: in every
+// synapse by default or, with "STDP_TRACES=neuron ./compile.sh", once per
+// neuron as presynaptic and postsynaptic variables (needs GeNN >= 3.2)
+#ifndef NEURON_STDP_TRACES
+#define NEURON_STDP_TRACES 0
+#endif
+
+#if STDP_DECAY_TABLE && NEURON_STDP_TRACES
+#error "Per-neuron STDP traces are only implemented with exp decays"
+#endif
+
+// E->E projections, chosen when building the model: both the plastic and
+// the static one by default, so --plastic picks between them at run time,
+// or, with "EE_PROJECTION=plastic|static ./compile.sh", only that one
+#ifndef EE_PLASTIC_PROJECTION
+#define EE_PLASTIC_PROJECTION 1
+#endif
+#ifndef EE_STATIC_PROJECTION
+#define EE_STATIC_PROJECTION 1
+#endif
+
+#if !EE_PLASTIC_PROJECTION && !EE_STATIC_PROJECTION
+#error "At least one E->E projection must be built"
+#endif
+
 //------------------------------------------------------------------------
 // Parameters
 //------------------------------------------------------------------------
@@ -10,6 +55,13 @@ namespace Parameters
 {
     const double timestep = 0.1;
 
+    const bool exactIntegration = (EXACT_INTEGRATION != 0);
+    const bool aggregatedPoisson = (AGGREGATED_POISSON != 0);
+    const bool stdpDecayTable = (STDP_DECAY_TABLE != 0);
+    const bool neuronSTDPTraces = (NEURON_STDP_TRACES != 0);
+    const bool eePlasticProjection = (EE_PLASTIC_PROJECTION != 0);
+    const bool eeStaticProjection = (EE_STATIC_PROJECTION != 0);
+
     // number of cells
     const unsigned int numNeurons = 10000;
 
@@ -27,6 +79,11 @@ namespace Parameters
     const unsigned int numExcitatory = (unsigned int)std::round(((double)numNeurons * excitatoryInhibitoryRatio) / (1.0 + excitatoryInhibitoryRatio));
     const unsigned int numInhibitory = numNeurons - numExcitatory;
 
+    // Poisson input: each LIF neuron receives numPoisson * probabilityConnection
+    // of the Poisson neurons on average (each targets that fraction of E and of I)
+    const double poissonRate = 20.0;
+    const unsigned int poissonInDegree = (unsigned int)(numPoisson * probabilityConnection);
+
     const unsigned int EEMaxRow = 884;
     const unsigned int EIMaxRow = 256;
     const unsigned int IIMaxRow = 247;
@@ -34,9 +91,17 @@ namespace Parameters
 
     const unsigned int synapticDelay = 15;
 
+    // STDP trace time constants (ms)
+    const double tauPlus = 20.0;
+    const double tauMinus = 20.0;
+
     const double scale = (4000.0 / (double)numNeurons) * (0.02 / probabilityConnection);
 
     const double excitatoryWeight = 0.1; // Plus conversion to amps
     const double inhibitoryWeight = -5.0f*excitatoryWeight; //
 
+    // STDP weight bounds (Wmin and Wmax of stdp_multiplicative.h)
+    const double stdpWeightMin = 0.0;
+    const double stdpWeightMax = 3.0f*excitatoryWeight;
+
 }
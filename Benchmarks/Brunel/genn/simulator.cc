@@ -1,5 +1,10 @@
 // Standard C++ includes
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <random>
+#include <string>
+#include <vector>
 
 // GeNN robotics includes
 //#include "common/timer.h"
@@ -7,6 +12,15 @@
 #include "timer.h"
 #include "spike_csv_recorder.h"
 
+// Shared benchmark utilities
+#include "../../common/checkpoint.h"
+#include "../../common/decay_table.h"
+#include "../../common/rate_watchdog.h"
+#include "../../common/thread_pool.h"
+#include "../../common/trace.h"
+#include "../../common/weight_histogram.h"
+#include "../../common/weight_monitor.h"
+
 // Model parameters
 #include "parameters.h"
 
@@ -22,18 +36,200 @@
 #include <sstream>
 #include <stdio.h>
 #include <fstream>
+#include <unistd.h>
 
 using namespace BoBRobotics;
+using namespace SNNBench;
+
+#if STDP_DECAY_TABLE
+//! Copy a decay table to where the synapse kernels can read it
+scalar *allocateDecayTable(const DecayTable &table)
+{
+    const std::vector<scalar> values(table.getValues().begin(), table.getValues().end());
+    const size_t size = values.size() * sizeof(scalar);
+#ifndef CPU_ONLY
+    scalar *d_values;
+    CHECK_CUDA_ERRORS(cudaMalloc(&d_values, size));
+    CHECK_CUDA_ERRORS(cudaMemcpy(d_values, values.data(), size, cudaMemcpyHostToDevice));
+    return d_values;
+#else
+    scalar *h_values = new scalar[values.size()];
+    std::copy(values.begin(), values.end(), h_values);
+    return h_values;
+#endif
+}
+#endif
+
+#ifndef CPU_ONLY
+//! Copy just the spike count of a delayed population's current step from
+//! the device, which is all the rate watchdog needs in fast mode
+unsigned int pullCurrentSpikeCount(const unsigned int *d_glbSpkCnt, unsigned int spkQuePtr)
+{
+    unsigned int count;
+    CHECK_CUDA_ERRORS(cudaMemcpy(&count, d_glbSpkCnt + spkQuePtr, sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    return count;
+}
+
+#if EE_PLASTIC_PROJECTION
+//! Copy only the plastic E->E weights back, rather than every variable
+//! and trace pullEEStateFromDevice copies
+void pullEEWeightsFromDevice()
+{
+    const size_t size = (size_t)Parameters::numExcitatory * Parameters::EEMaxRow * sizeof(scalar);
+    CHECK_CUDA_ERRORS(cudaMemcpy(gEE, d_gEE, size, cudaMemcpyDeviceToHost));
+}
+#endif
+#endif
+
+//! CPU time of the calling thread alone, where clock() counts every thread's
+double getThreadCPUSeconds()
+{
+    timespec cpuTime;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+    return (double)cpuTime.tv_sec + ((double)cpuTime.tv_nsec * 1.0E-9);
+}
+
+//! Copy the E->E weights out of GeNN's rows, padded to EEMaxRow, into row
+//! order as Weights.bin holds them
+void gatherEEWeights(bool plastic, std::vector<float> &weights)
+{
+#if EE_PLASTIC_PROJECTION && EE_STATIC_PROJECTION
+    const unsigned int *eeRowLength = plastic ? CEE.rowLength : CEEStatic.rowLength;
+    const scalar *eeWeights = plastic ? gEE : gEEStatic;
+#elif EE_PLASTIC_PROJECTION
+    const unsigned int *eeRowLength = CEE.rowLength;
+    const scalar *eeWeights = gEE;
+#else
+    const unsigned int *eeRowLength = CEEStatic.rowLength;
+    const scalar *eeWeights = gEEStatic;
+#endif
+    weights.clear();
+    for (unsigned int pre = 0; pre < Parameters::numExcitatory; pre++) {
+      const scalar *row = &eeWeights[pre * Parameters::EEMaxRow];
+      weights.insert(weights.end(), row, row + eeRowLength[pre]);
+    }
+}
+
+// Changed whenever the sections of an image are
+const uint64_t ImageVersion = 1;
+
+//! A ragged projection's rows in GeNN's host arrays, each padded to maxRow
+struct RaggedConnectivity
+{
+    std::string name;
+    unsigned int *rowLength;
+    unsigned int *ind;
+    unsigned int numPre;
+    unsigned int maxRow;
+};
+
+//! The projections whose rows are generated or loaded from the .wmat files
+//! before initbrunel_benchmark: the Poisson input's and, of the E->E ones,
+//! only the one in use
+std::vector<RaggedConnectivity> getConnectivity(bool plastic)
+{
+    std::vector<RaggedConnectivity> connectivity;
+#if !AGGREGATED_POISSON
+    connectivity.push_back({"pe", CPE.rowLength, CPE.ind, Parameters::numPoisson, (unsigned int)(Parameters::numExcitatory*Parameters::probabilityConnection)});
+    connectivity.push_back({"pi", CPI.rowLength, CPI.ind, Parameters::numPoisson, (unsigned int)(Parameters::numInhibitory*Parameters::probabilityConnection)});
+#endif
+#if EE_PLASTIC_PROJECTION && EE_STATIC_PROJECTION
+    connectivity.push_back({"ee", plastic ? CEE.rowLength : CEEStatic.rowLength, plastic ? CEE.ind : CEEStatic.ind, Parameters::numExcitatory, Parameters::EEMaxRow});
+#elif EE_PLASTIC_PROJECTION
+    connectivity.push_back({"ee", CEE.rowLength, CEE.ind, Parameters::numExcitatory, Parameters::EEMaxRow});
+#else
+    connectivity.push_back({"ee", CEEStatic.rowLength, CEEStatic.ind, Parameters::numExcitatory, Parameters::EEMaxRow});
+#endif
+    connectivity.push_back({"ei", CEI.rowLength, CEI.ind, Parameters::numExcitatory, Parameters::EIMaxRow});
+    connectivity.push_back({"ii", CII.rowLength, CII.ind, Parameters::numInhibitory, Parameters::IIMaxRow});
+    connectivity.push_back({"ie", CIE.rowLength, CIE.ind, Parameters::numInhibitory, Parameters::IEMaxRow});
+    return connectivity;
+}
+
+//! What an image must match to stand in for loading: the build and run
+//! options that decide which projections are filled, the model parameters
+//! that size them, then the stamp of each .wmat file
+bool getImageKey(bool plastic, std::vector<uint64_t> &key)
+{
+    key = {ImageVersion, plastic ? 1u : 0u, EE_PLASTIC_PROJECTION, EE_STATIC_PROJECTION, AGGREGATED_POISSON,
+           Parameters::numExcitatory, Parameters::numInhibitory, Parameters::numPoisson,
+           Parameters::EEMaxRow, Parameters::EIMaxRow, Parameters::IIMaxRow, Parameters::IEMaxRow};
+    for (const char *name : {"../ee.wmat", "../ei.wmat", "../ie.wmat", "../ii.wmat"}) {
+      if (!Checkpoint::appendFileStamp(name, key)) return false;
+    }
+    return true;
+}
+
+//! Write the rows generated and loaded at startup to image, so a later run
+//! can start with loadImage instead. Returns false if the .wmat files can't
+//! be identified
+bool saveImage(Checkpoint::Writer &image, bool plastic)
+{
+    Trace::Scope trace("Save image", "output");
+
+    std::vector<uint64_t> key;
+    if (!getImageKey(plastic, key)) return false;
+    image.write("image_key", key);
+    for (const auto &c : getConnectivity(plastic)) {
+      image.write(c.name + "_row_length", c.rowLength, c.numPre);
+      image.write(c.name + "_ind", c.ind, (size_t)c.numPre * c.maxRow);
+    }
+    return true;
+}
+
+//! Fill GeNN's host arrays from an image saveImage wrote rather than
+//! generating and loading them, returning false (leaving them to be loaded)
+//! unless it was written with the same options, model parameters and, judged
+//! by their sizes and modification times, .wmat files
+bool loadImage(const Checkpoint::Reader &image, bool plastic)
+{
+    Trace::Scope trace("Load image", "loader");
+
+    std::vector<uint64_t> key, imageKey;
+    if (!getImageKey(plastic, key) || !image.read("image_key", imageKey) || imageKey != key) {
+      fprintf(stderr, "Image was built from other connectivity or model options\n");
+      return false;
+    }
+    for (const auto &c : getConnectivity(plastic)) {
+      if (!image.read(c.name + "_row_length", c.rowLength, c.numPre)
+          || !image.read(c.name + "_ind", c.ind, (size_t)c.numPre * c.maxRow)) return false;
+    }
+    return true;
+}
 
 int main (int argc, char *argv[])
 {
     // Getting options:
     float simtime = 20.0;
     bool fast = false;
+    bool plastic = false;
+    unsigned int trace_every = 0;
+    float weight_every = 0.0f;
+    WeightMonitor::Encoding weight_encoding = WeightMonitor::Encoding::Full;
+    float hist_every = 0.0f;
+    unsigned int hist_bins = 100;
+    float min_rate = 0.0f, max_rate = 0.0f;
+    float rate_window = 100.0f;
+    std::string image_file;
     const char* const short_opts = "";
     const option long_opts[] = {
       {"simtime", 1, nullptr, 0},
       {"fast", 0, nullptr, 1},
+      {"trace", 0, nullptr, 2},
+      {"trace_every", 1, nullptr, 3},
+      {"integrator", 1, nullptr, 4},
+      {"poisson_input", 1, nullptr, 5},
+      {"stdp_decay", 1, nullptr, 6},
+      {"stdp_traces", 1, nullptr, 7},
+      {"plastic", 0, nullptr, 8},
+      {"weight_every", 1, nullptr, 9},
+      {"weight_encoding", 1, nullptr, 10},
+      {"hist_every", 1, nullptr, 11},
+      {"hist_bins", 1, nullptr, 12},
+      {"rate_watchdog", 1, nullptr, 13},
+      {"rate_window", 1, nullptr, 14},
+      {"image", 1, nullptr, 15},
+      {nullptr, 0, nullptr, 0}
     };
     // Check the set of options
     while (true) {
@@ -51,44 +247,170 @@ int main (int argc, char *argv[])
           printf("Running in fast mode (no spike collection)\n");
           fast = true;
           break;
+        case 2:
+          printf("Writing a chrome://tracing timeline to trace.json\n");
+          Trace::enable();
+          break;
+        case 3:
+          printf("Tracing every %s simulation steps\n", optarg);
+          trace_every = std::stoi(optarg);
+          Trace::enable();
+          break;
+        case 4:
+          // The integrator is part of the generated code, so can only be checked here
+          if (std::string(optarg) != (Parameters::exactIntegration ? "exact" : "euler")) {
+            fprintf(stderr, "Model was built with %s integration; rebuild with INTEGRATOR=%s ./compile.sh\n",
+                    Parameters::exactIntegration ? "exact" : "euler", optarg);
+            return 1;
+          }
+          break;
+        case 5:
+          // As is the Poisson input
+          if (std::string(optarg) != (Parameters::aggregatedPoisson ? "aggregated" : "neurons")) {
+            fprintf(stderr, "Model was built with %s Poisson input; rebuild with POISSON_INPUT=%s ./compile.sh\n",
+                    Parameters::aggregatedPoisson ? "aggregated" : "neurons", optarg);
+            return 1;
+          }
+          break;
+        case 6:
+          // And the STDP trace decay
+          if (std::string(optarg) != (Parameters::stdpDecayTable ? "table" : "exp")) {
+            fprintf(stderr, "Model was built with %s STDP decay; rebuild with STDP_DECAY=%s ./compile.sh\n",
+                    Parameters::stdpDecayTable ? "table" : "exp", optarg);
+            return 1;
+          }
+          break;
+        case 7:
+          // And where the STDP traces are held
+          if (std::string(optarg) != (Parameters::neuronSTDPTraces ? "neuron" : "synapse")) {
+            fprintf(stderr, "Model was built with per-%s STDP traces; rebuild with STDP_TRACES=%s ./compile.sh\n",
+                    Parameters::neuronSTDPTraces ? "neuron" : "synapse", optarg);
+            return 1;
+          }
+          break;
+        case 8:
+          printf("Running with STDP on the E->E synapses\n");
+          plastic = true;
+          break;
+        case 9:
+          printf("Streaming E->E weight snapshots every %sms to weight_stream.bin\n", optarg);
+          weight_every = std::stof(optarg);
+          break;
+        case 10:
+          if (std::string(optarg) == "full") weight_encoding = WeightMonitor::Encoding::Full;
+          else if (std::string(optarg) == "delta") weight_encoding = WeightMonitor::Encoding::Delta;
+          else {
+            fprintf(stderr, "Unknown weight encoding '%s' (full or delta)\n", optarg);
+            return 1;
+          }
+          printf("Weight snapshot encoding: %s\n", optarg);
+          break;
+        case 11:
+          printf("Logging E->E weight histograms every %sms to weight_hist.tsv\n", optarg);
+          hist_every = std::stof(optarg);
+          break;
+        case 12:
+          printf("Weight histogram bins: %s\n", optarg);
+          hist_bins = std::stoi(optarg);
+          break;
+        case 13:
+          if (!RateWatchdog::parseBand(optarg, min_rate, max_rate)) {
+            fprintf(stderr, "Rate watchdog band '%s' is not MIN,MAX in Hz\n", optarg);
+            return 1;
+          }
+          printf("Aborting if E or I rates leave [%g, %g]Hz\n", min_rate, max_rate);
+          break;
+        case 14:
+          printf("Rate watchdog window: %sms\n", optarg);
+          rate_window = std::stof(optarg);
+          break;
+        case 15:
+          printf("Post-initialisation image: %s\n", optarg);
+          image_file = optarg;
+          break;
         default:
           break;
       }
     };
+    // A model built with a single E->E projection can only be run that way
+    if (plastic ? !Parameters::eePlasticProjection : !Parameters::eeStaticProjection) {
+      fprintf(stderr, "Model was built without the %s E->E projection; rebuild with EE_PROJECTION=%s ./compile.sh\n",
+              plastic ? "plastic" : "static", plastic ? "plastic" : "static");
+      return 1;
+    }
     {
         Timer<> t("Allocation:");
+        Trace::Scope s("Allocation");
         allocateMem();
     }
     
     {
         Timer<> t("Initialization:");
+        Trace::Scope s("Initialization");
         initialize();
     }
     
-    // Loading Synapses
+    // Loading Synapses, from the post-initialisation image of an earlier run if it is still valid
+    bool from_image = false;
     {
         Timer<> t("Synapse setup:");
-        random_connectivity(CPE.ind, CPE.rowLength, Parameters::numPoisson, Parameters::numExcitatory, Parameters::numExcitatory*Parameters::probabilityConnection, 42);
+        Trace::Scope s("Synapse setup");
+        if (!image_file.empty() && access(image_file.c_str(), F_OK) == 0) {
+          const Checkpoint::Reader image(image_file);
+          from_image = image.isValid() && loadImage(image, plastic);
+        }
+#if !AGGREGATED_POISSON
+        if (!from_image) random_connectivity(CPE.ind, CPE.rowLength, Parameters::numPoisson, Parameters::numExcitatory, Parameters::numExcitatory*Parameters::probabilityConnection, 42);
         reset_array(inSynPE, Parameters::numPoisson);
         pushPEStateToDevice();
-        random_connectivity(CPI.ind, CPI.rowLength, Parameters::numPoisson, Parameters::numInhibitory, Parameters::numInhibitory*Parameters::probabilityConnection, 43);
+        if (!from_image) random_connectivity(CPI.ind, CPI.rowLength, Parameters::numPoisson, Parameters::numInhibitory, Parameters::numInhibitory*Parameters::probabilityConnection, 43);
         reset_array(inSynPI, Parameters::numPoisson);
         pushPIStateToDevice();
+#else
+        printf("Poisson input aggregated into a Binomial(%u, %g) draw per neuron and step\n",
+               Parameters::poissonInDegree, Parameters::poissonRate * Parameters::timestep / 1000.0);
+#endif
 
 
-        ragged_connectivity_from_mat("../ee.wmat", CEE.ind, CEE.rowLength, Parameters::numExcitatory, Parameters::EEMaxRow);
+#if EE_PLASTIC_PROJECTION && EE_STATIC_PROJECTION
+        // E->E synapses go into the plastic or the static projection, the other is left empty
+        unsigned int *eeRowLength = plastic ? CEE.rowLength : CEEStatic.rowLength;
+        unsigned int *emptyRowLength = plastic ? CEEStatic.rowLength : CEE.rowLength;
+        if (!from_image) ragged_connectivity_from_mat("../ee.wmat", plastic ? CEE.ind : CEEStatic.ind, eeRowLength,
+                                     Parameters::numExcitatory, Parameters::EEMaxRow);
+        std::fill_n(emptyRowLength, Parameters::numExcitatory, 0);
+#elif EE_PLASTIC_PROJECTION
+        if (!from_image) ragged_connectivity_from_mat("../ee.wmat", CEE.ind, CEE.rowLength, Parameters::numExcitatory, Parameters::EEMaxRow);
+#else
+        if (!from_image) ragged_connectivity_from_mat("../ee.wmat", CEEStatic.ind, CEEStatic.rowLength, Parameters::numExcitatory, Parameters::EEMaxRow);
+#endif
+#if EE_PLASTIC_PROJECTION
         reset_array(inSynEE, Parameters::numExcitatory);
         pushEEStateToDevice();
+#endif
+#if EE_STATIC_PROJECTION
+        reset_array(inSynEEStatic, Parameters::numExcitatory);
+        pushEEStaticStateToDevice();
+#endif
+
+#if STDP_DECAY_TABLE && EE_PLASTIC_PROJECTION
+        // Trace decay tables of STDPWeightDependentTable
+        const DecayTable plusDecay(Parameters::tauPlus, Parameters::timestep);
+        const DecayTable minusDecay(Parameters::tauMinus, Parameters::timestep);
+        tauPlusDecayEE = allocateDecayTable(plusDecay);
+        tauMinusDecayEE = allocateDecayTable(minusDecay);
+        printf("STDP trace decays looked up for intervals under %g ms\n", DecayTable::DefaultLength * Parameters::timestep);
+#endif
 
-        ragged_connectivity_from_mat("../ei.wmat", CEI.ind, CEI.rowLength, Parameters::numExcitatory, Parameters::EIMaxRow);
+        if (!from_image) ragged_connectivity_from_mat("../ei.wmat", CEI.ind, CEI.rowLength, Parameters::numExcitatory, Parameters::EIMaxRow);
         reset_array(inSynEI, Parameters::numInhibitory);
         pushEIStateToDevice();
 
-        ragged_connectivity_from_mat("../ii.wmat", CII.ind, CII.rowLength, Parameters::numInhibitory, Parameters::IIMaxRow);
+        if (!from_image) ragged_connectivity_from_mat("../ii.wmat", CII.ind, CII.rowLength, Parameters::numInhibitory, Parameters::IIMaxRow);
         reset_array(inSynII, Parameters::numInhibitory);
         pushIIStateToDevice();
 
-        ragged_connectivity_from_mat("../ie.wmat", CIE.ind, CIE.rowLength, Parameters::numInhibitory, Parameters::IEMaxRow);
+        if (!from_image) ragged_connectivity_from_mat("../ie.wmat", CIE.ind, CIE.rowLength, Parameters::numInhibitory, Parameters::IEMaxRow);
         reset_array(inSynIE, Parameters::numExcitatory);
         pushIEStateToDevice();
     }
@@ -96,57 +418,154 @@ int main (int argc, char *argv[])
     // Final setup
     {
         Timer<> t("Sparse init:");
+        Trace::Scope s("Sparse init");
         initbrunel_benchmark();
     }
+    if (!from_image && !image_file.empty()) {
+      Checkpoint::Writer image(image_file);
+      if (saveImage(image, plastic) && image.finish()) printf("Wrote %.1fMB image to %s\n", (double)image.getNumBytes() / (1024.0 * 1024.0), image_file.c_str());
+    }
 
     // Open CSV output files
     GeNNUtils::SpikeCSVRecorderDelay spikes("spikes.csv", 8000, spkQuePtrE, glbSpkCntE, glbSpkE);
     GeNNUtils::SpikeCSVRecorderDelay i_spikes("inh_spikes.csv", 2000, spkQuePtrI, glbSpkCntI, glbSpkI);
+#if !AGGREGATED_POISSON
     GeNNUtils::SpikeCSVRecorderDelay p_spikes("pois_spikes.csv", 10000, spkQuePtrP, glbSpkCntP, glbSpkP);
+#endif
+
+    // E->E weight snapshots, written on a background thread
+    const unsigned int weight_steps = (unsigned int)std::round(weight_every / Parameters::timestep);
+    std::vector<float> weights;
+    std::unique_ptr<WeightMonitor> weight_monitor;
+    if (weight_steps > 0) {
+      gatherEEWeights(plastic, weights);
+      weight_monitor.reset(new WeightMonitor("weight_stream.bin", weights.size(), weight_encoding));
+      if (!weight_monitor->isOpen()) return 1;
+    }
+
+    // E->E weight histograms between the STDP weight bounds, binned on this thread alone
+    const unsigned int hist_steps = (unsigned int)std::round(hist_every / Parameters::timestep);
+    ThreadPool hist_pool(1);
+    std::unique_ptr<WeightHistogram::Logger> weight_hist;
+    if (hist_steps > 0) {
+      weight_hist.reset(new WeightHistogram::Logger("weight_hist.tsv",
+                                                    WeightHistogram::Binning((float)Parameters::stdpWeightMin, (float)Parameters::stdpWeightMax, hist_bins),
+                                                    hist_pool));
+      if (!weight_hist->isOpen()) return 1;
+    }
+
+    // Stops runaway or silent runs, even in fast mode
+    const bool watch_rates = (max_rate > 0.0f);
+    RateWatchdog watchdog(min_rate, max_rate, rate_window, Parameters::timestep);
+    watchdog.addPopulation("E", Parameters::numExcitatory);
+    watchdog.addPopulation("I", Parameters::numInhibitory);
 
-    clock_t totaltime;
+    // Process CPU time, less the time spent taking weight snapshots and
+    // histograms and the CPU time of the thread writing the snapshots
+    double totaltime;
+    double recordtime = 0.0;
     {
         Timer<> t("Simulation:");
+        Trace::Scope s("Simulation", "simulation");
         // Loop through timesteps
         int timesteps_per_second = 10000;
         clock_t starttime = clock();
         for(unsigned int t = 0; t < (int)(simtime*timesteps_per_second); t++)
         {
+            const bool trace_step = Trace::shouldTraceStep(t, trace_every);
+            Trace::Scope step("Step", "simulation", trace_step);
+
             // Simulate
 #ifndef CPU_ONLY
             stepTimeGPU();
 
-            if (!fast) pullECurrentSpikesFromDevice();
-            if (!fast) pullPCurrentSpikesFromDevice();
-            if (!fast) pullICurrentSpikesFromDevice();
+            if (!fast) {
+                Trace::Scope pull("Pull spikes", "recording", trace_step);
+                pullECurrentSpikesFromDevice();
+#if !AGGREGATED_POISSON
+                pullPCurrentSpikesFromDevice();
+#endif
+                pullICurrentSpikesFromDevice();
+            }
 #else
             stepTimeCPU();
 #endif
 
-            if (!fast) spikes.record(t);
-            if (!fast) p_spikes.record(t);
-            if (!fast) i_spikes.record(t);
+            if (!fast) {
+                Trace::Scope record("Record spikes", "recording", trace_step);
+                spikes.record(t);
+#if !AGGREGATED_POISSON
+                p_spikes.record(t);
+#endif
+                i_spikes.record(t);
+            }
+
+            if (watch_rates) {
+#ifndef CPU_ONLY
+                if (fast) {
+                  watchdog.addSpikes(0, pullCurrentSpikeCount(d_glbSpkCntE, spkQuePtrE));
+                  watchdog.addSpikes(1, pullCurrentSpikeCount(d_glbSpkCntI, spkQuePtrI));
+                }
+                else
+#endif
+                {
+                  watchdog.addSpikes(0, glbSpkCntE[spkQuePtrE]);
+                  watchdog.addSpikes(1, glbSpkCntI[spkQuePtrI]);
+                }
+                if (!watchdog.endStep()) {
+                  watchdog.printDiagnostic();
+                  return 2;
+                }
+            }
+
+            const bool snapshot_step = (weight_steps > 0 && ((t + 1) % weight_steps) == 0);
+            const bool hist_step = (hist_steps > 0 && ((t + 1) % hist_steps) == 0);
+            if (snapshot_step || hist_step) {
+                const double snapshotstart = getThreadCPUSeconds();
+#if !defined(CPU_ONLY) && EE_PLASTIC_PROJECTION
+                if (plastic) {
+                  pullEEWeightsFromDevice();
+                }
+#endif
+                gatherEEWeights(plastic, weights);
+                if (snapshot_step) weight_monitor->record(t + 1, weights.data());
+                if (hist_step) weight_hist->record((double)(t + 1) * Parameters::timestep, weights.data(), weights.size());
+                recordtime += getThreadCPUSeconds() - snapshotstart;
+            }
+        }
+        if (weight_monitor) {
+          const double recordstart = getThreadCPUSeconds();
+          if (!weight_monitor->finish()) return 1;
+          recordtime += (getThreadCPUSeconds() - recordstart) + weight_monitor->getWriterCPUSeconds();
         }
-        totaltime = clock() - starttime;
+        totaltime = ((double)(clock() - starttime) / CLOCKS_PER_SEC) - recordtime;
     }
     if ( fast ){
       std::ofstream timefile;
       timefile.open("timefile.dat");
-      timefile << std::setprecision(10) << ((float)totaltime / CLOCKS_PER_SEC);
+      timefile << std::setprecision(10) << (float)totaltime;
       timefile.close();
     }
        
     // Get weights back
+    Trace::Scope dump("Weight dump", "output");
+#if EE_PLASTIC_PROJECTION && EE_STATIC_PROJECTION
+    if (plastic) {
+      pullEEStateFromDevice();
+    }
+    else {
+      pullEEStaticStateFromDevice();
+    }
+#elif EE_PLASTIC_PROJECTION
     pullEEStateFromDevice();
+#else
+    pullEEStaticStateFromDevice();
+#endif
+    gatherEEWeights(plastic, weights);
 
     ofstream weightfile;
     weightfile.open(("./Weights.bin"), ios::out | ios::binary);
-
-    for (int pre = 0; pre < 8000; pre++){
-      for (int post = 0; post < CEE.rowLength[pre]; post++){
-        weightfile.write((char*)&gEE[pre*Parameters::EEMaxRow + post], sizeof(scalar));
-      }
-    }
+    weightfile.write((const char*)weights.data(), weights.size() * sizeof(float));
     weightfile.close();
     
 
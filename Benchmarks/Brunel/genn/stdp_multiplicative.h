@@ -114,3 +114,158 @@ public:
 };
 
 IMPLEMENT_MODEL(STDPWeightDependent);
+
+//----------------------------------------------------------------------------
+// STDPWeightDependentTable
+//----------------------------------------------------------------------------
+//! STDPWeightDependent with the trace decays looked up rather than computed.
+//! Traces are only decayed at spike times, so the time since their last
+//! update is a whole number of timesteps n and exp(-n * DT / tau) is entry
+//! n of the tauPlusDecay or tauMinusDecay extra global parameter (filled
+//! with SNNBench::DecayTable), with exp for intervals beyond the table
+class STDPWeightDependentTable : public WeightUpdateModels::Base
+{
+public:
+    DECLARE_MODEL(STDPWeightDependentTable, 9, 5);
+
+    SET_PARAM_NAMES({
+      "tauPlus",  // 0 - Potentiation time constant (ms)
+      "tauMinus", // 1 - Depression time constant (ms)
+      "Aplus",    // 2 - Rate of potentiation
+      "Aminus",   // 3 - Rate of depression
+      "Wmin",     // 4 - Minimum weight
+      "Wmax",     // 5 - Maximum weight
+      "lambda",   // 6 - Learning Rate
+      "alpha",    // 7 - Relative Weighting (LTP to LTD)
+      "tableLength", // 8 - Entries in each decay table
+    });
+
+    SET_VARS({
+      {"g", "scalar"},
+      {"pre_trace", "scalar"},
+      {"post_trace", "scalar"},
+      {"t_preUpdate", "scalar"},
+      {"t_postUpdate", "scalar"},
+  });
+
+    SET_EXTRA_GLOBAL_PARAMS({
+      {"tauPlusDecay", "scalar*"},
+      {"tauMinusDecay", "scalar*"},
+  });
+
+    SET_SIM_CODE(
+        "$(addtoinSyn) = $(g);\n"
+        "$(updatelinsyn);\n"
+        // Decay Pre and Add Aplus
+        "    scalar predt = $(t) - $(t_preUpdate);\n"
+        "    $(t_preUpdate) = $(t);\n"
+        "    const int preSteps = (int)((predt / DT) + 0.5);\n"
+        "    scalar preDecay = (preSteps < $(tableLength)) ? $(tauPlusDecay)[preSteps] : exp(- predt / $(tauPlus));\n"
+        "    $(pre_trace) *= preDecay;\n"
+        "    $(pre_trace) += $(Aplus);\n"
+
+        // Decay Post and Carry out update
+        "    scalar postdt = $(t) - $(t_postUpdate);\n"
+        "    const int postSteps = (int)((postdt / DT) + 0.5);\n"
+        "    scalar decayamount = (postSteps < $(tableLength)) ? $(tauMinusDecay)[postSteps] : exp(- postdt / $(tauMinus));\n"
+        "    $(t_postUpdate) = $(t);\n"
+        "    $(post_trace) *= decayamount;\n"
+        "    scalar newWeight = $(g) - $(lambda)*$(alpha)*$(g)*$(post_trace);\n"
+        "    $(g) = (newWeight < $(Wmin)) ? $(Wmin) : newWeight;\n"
+      );
+    SET_LEARN_POST_CODE(
+        // Decay Post and Add Aminus
+        "    scalar postdt = $(t) - $(t_postUpdate);\n"
+        "    const int postSteps = (int)((postdt / DT) + 0.5);\n"
+        "    scalar postDecay = (postSteps < $(tableLength)) ? $(tauMinusDecay)[postSteps] : exp(- postdt / $(tauMinus));\n"
+        "    $(t_postUpdate) = $(t);\n"
+        "    $(post_trace) *= postDecay;\n"
+        "    $(post_trace) += $(Aminus);\n"
+
+        // Decay pre and modify weight
+        "    scalar predt = $(t) - $(t_preUpdate);\n"
+        "    const int preSteps = (int)((predt / DT) + 0.5);\n"
+        "    scalar decayamount = (preSteps < $(tableLength)) ? $(tauPlusDecay)[preSteps] : exp(- predt / $(tauPlus));\n"
+        "    $(pre_trace) *= decayamount;\n"
+        "    $(t_preUpdate) = $(t);\n"
+        "    scalar newWeight = $(g) + $(lambda)*($(Wmax) - $(g))*$(pre_trace);\n"
+        "    $(g) = (newWeight > $(Wmax)) ? $(Wmax) : newWeight;\n"
+        );
+};
+
+IMPLEMENT_MODEL(STDPWeightDependentTable);
+
+//----------------------------------------------------------------------------
+// STDPWeightDependentNeuronTraces
+//----------------------------------------------------------------------------
+//! STDPWeightDependent with only g held per synapse. Each pre trace only
+//! changes when its presynaptic neuron's spikes arrive and each post trace
+//! when its postsynaptic neuron spikes, so both (and their update times)
+//! are presynaptic and postsynaptic variables updated once per spike.
+//!
+//! The pre and post spike code runs when the neuron spikes, so the update
+//! times are shifted to when STDPWeightDependent makes them: arrivalDelay
+//! ms later for pre traces and one step later (in the learn post code) for
+//! post traces. A trace read before its latest update takes effect has
+//! that update's increment removed, which is exact unless a neuron spikes
+//! twice within arrivalDelay
+class STDPWeightDependentNeuronTraces : public WeightUpdateModels::Base
+{
+public:
+    DECLARE_MODEL(STDPWeightDependentNeuronTraces, 9, 1);
+
+    SET_PARAM_NAMES({
+      "tauPlus",  // 0 - Potentiation time constant (ms)
+      "tauMinus", // 1 - Depression time constant (ms)
+      "Aplus",    // 2 - Rate of potentiation
+      "Aminus",   // 3 - Rate of depression
+      "Wmin",     // 4 - Minimum weight
+      "Wmax",     // 5 - Maximum weight
+      "lambda",   // 6 - Learning Rate
+      "alpha",    // 7 - Relative Weighting (LTP to LTD)
+      "arrivalDelay", // 8 - Time from a presynaptic spike to its sim code (ms)
+    });
+
+    SET_VARS({{"g", "scalar"}});
+    SET_PRE_VARS({
+      {"pre_trace", "scalar"},
+      {"t_preUpdate", "scalar"},
+  });
+    SET_POST_VARS({
+      {"post_trace", "scalar"},
+      {"t_postUpdate", "scalar"},
+  });
+
+    // Decay Pre to its arrival and Add Aplus
+    SET_PRE_SPIKE_CODE(
+        "    const scalar tArrival = $(t) + $(arrivalDelay);\n"
+        "    $(pre_trace) = ($(pre_trace) * exp(- (tArrival - $(t_preUpdate)) / $(tauPlus))) + $(Aplus);\n"
+        "    $(t_preUpdate) = tArrival;\n"
+        );
+
+    // Decay Post to the learn post step and Add Aminus
+    SET_POST_SPIKE_CODE(
+        "    const scalar tLearn = $(t) + DT;\n"
+        "    $(post_trace) = ($(post_trace) * exp(- (tLearn - $(t_postUpdate)) / $(tauMinus))) + $(Aminus);\n"
+        "    $(t_postUpdate) = tLearn;\n"
+        );
+
+    SET_SIM_CODE(
+        "$(addtoinSyn) = $(g);\n"
+        "$(updatelinsyn);\n"
+        // Post trace as STDPWeightDependent's sim code sees it, before this step's learn post code
+        "    const scalar postdt = $(t) - $(t_postUpdate);\n"
+        "    const scalar postTrace = (postdt < (0.5 * DT)) ? ($(post_trace) - $(Aminus)) : $(post_trace);\n"
+        "    scalar newWeight = $(g) - $(lambda)*$(alpha)*$(g)*postTrace*exp(- postdt / $(tauMinus));\n"
+        "    $(g) = (newWeight < $(Wmin)) ? $(Wmin) : newWeight;\n"
+      );
+    SET_LEARN_POST_CODE(
+        // Pre trace without the increment of a spike which has not yet arrived
+        "    const scalar predt = $(t) - $(t_preUpdate);\n"
+        "    const scalar preTrace = (predt < (-0.5 * DT)) ? ($(pre_trace) - $(Aplus)) : $(pre_trace);\n"
+        "    scalar newWeight = $(g) + $(lambda)*($(Wmax) - $(g))*preTrace*exp(- predt / $(tauPlus));\n"
+        "    $(g) = (newWeight > $(Wmax)) ? $(Wmax) : newWeight;\n"
+        );
+};
+
+IMPLEMENT_MODEL(STDPWeightDependentNeuronTraces);
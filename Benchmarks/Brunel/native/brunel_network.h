@@ -0,0 +1,666 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Shared benchmark utilities
+#include "../../common/checkpoint.h"
+#include "../../common/decay_table.h"
+#include "../../common/delay_queue.h"
+#include "../../common/lif_kernels.h"
+#include "../../common/philox.h"
+#include "../../common/ragged_matrix.h"
+#include "../../common/shared_connectivity.h"
+#include "../../common/thread_pool.h"
+#include "../../common/trace.h"
+
+// Model parameters shared with the GeNN implementation
+#include "../genn/parameters.h"
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::BrunelNetwork
+//------------------------------------------------------------------------
+//! Native multi-threaded CPU implementation of the GeNN Brunel model in
+//! genn/model.cc: LIF neurons with DeltaCurr synapses driven by a
+//! population of Poisson neurons, every projection delayed by
+//! Parameters::synapticDelay. In plastic mode the E->E synapses follow
+//! STDPWeightDependent (additive potentiation, multiplicative depression
+//! weighted by alpha). Neurons are indexed globally as E, I then Poisson
+//! and the LIF neurons are updated by the LIFKernels version for isa, with
+//! either the forward Euler step of LIF or the exact propagator of LIFExact.
+//!
+//! GeNN keeps the STDP traces in every synapse but, as each is only ever
+//! changed by spikes of its own pre or postsynaptic neuron, they are held
+//! once per neuron here and decayed lazily to the time they are needed,
+//! either with exp as GeNN does or by looking the decay up in a DecayTable.
+//!
+//! Given a maxSynapticDelay above Parameters::synapticDelay, each static
+//! synapse gets a delay drawn uniformly between the two and is delivered
+//! through a DelayQueue of DelayedMatrix row segments. Plastic E->E
+//! synapses keep the uniform delay, as a neuron's trace is updated once
+//! when its spike arrives
+class BrunelNetwork
+{
+public:
+    BrunelNetwork(bool plastic, unsigned int maxSynapticDelay, ThreadPool &pool, LIFKernels::Integrator integrator = LIFKernels::Integrator::Euler,
+                  LIFKernels::ISA isa = LIFKernels::detect())
+    :   m_Plastic(plastic), m_ISA(isa), m_Pool(pool), m_V(NumLIF, (float)Parameters::restVoltage), m_RefracTime(NumLIF, 0.0f),
+        m_InSyn(NumLIF, 0.0f), m_PreTrace(Parameters::numExcitatory, 0.0f), m_PreUpdateTime(Parameters::numExcitatory, 0.0f),
+        m_PostTrace(Parameters::numExcitatory, 0.0f), m_PostUpdateTime(Parameters::numExcitatory, 0.0f),
+        m_MaxDelay(std::max(Parameters::synapticDelay, maxSynapticDelay)), m_StaticQueue(m_MaxDelay),
+        m_PlasticQueue(Parameters::synapticDelay), m_Step(0), m_PoissonSeed(PoissonSeed),
+        m_Threads(pool.getNumThreads()), m_Lambda(0.01f), m_UseDecayTable(false),
+        m_PlusDecay(TauPlus, Parameters::timestep), m_MinusDecay(TauMinus, Parameters::timestep), m_SharedConnectivity(false)
+    {
+        const float dt = (float)Parameters::timestep;
+        m_KernelParams.membraneStep = LIFKernels::getMembraneStep(integrator, Parameters::timestep, TauM);
+        m_KernelParams.vRest = (float)Parameters::restVoltage;
+        m_KernelParams.vReset = (float)Parameters::resetVoltage;
+        m_KernelParams.vThresh = (float)Parameters::thresholdVoltage;
+        m_KernelParams.ioffset = Ioffset;
+        m_KernelParams.tauRefrac = TauRefrac;
+        m_KernelParams.dt = dt;
+
+        // PoissonNew's exponential inter-spike intervals, counted in whole
+        // steps, are geometric: a spike each step with this probability
+        m_PoissonThreshold = (float)(1.0 - std::exp(-(double)PoissonRate * Parameters::timestep / 1000.0));
+
+        for(auto &t : m_Threads) {
+            t.inSyn.assign(NumLIF, 0.0f);
+            t.spikes.resize(NumLIF + LIFKernels::VectorSlack);
+            t.numSpikes = 0;
+            t.hasInput = false;
+            t.numEvents = 0;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Load the recurrent connectivity from the .wmat files in directory and
+    //! generate the Poisson input connectivity as genn/matLoader.h does. As
+    //! in the GeNN model, the weights are Parameters::excitatoryWeight and
+    //! Parameters::inhibitoryWeight rather than those in the files
+    bool loadConnectivity(const std::string &directory)
+    {
+        Trace::Scope trace("Load connectivity", "loader");
+
+        RaggedMatrix ee, ei, ie, ii;
+        if(!loadWmatFile(directory + "/ee.wmat", ee) || !loadWmatFile(directory + "/ei.wmat", ei)
+           || !loadWmatFile(directory + "/ie.wmat", ie) || !loadWmatFile(directory + "/ii.wmat", ii))
+        {
+            return false;
+        }
+
+        const unsigned int numPE = (unsigned int)(Parameters::numExcitatory * Parameters::probabilityConnection);
+        const unsigned int numPI = (unsigned int)(Parameters::numInhibitory * Parameters::probabilityConnection);
+        RaggedMatrix pe, pi;
+        randomConnectivity(Parameters::numExcitatory, numPE, 42, pe);
+        randomConnectivity(Parameters::numInhibitory, numPI, 43, pi);
+
+        // Static rows of every presynaptic neuron, with E->E only when it isn't plastic
+        const float excWeight = (float)Parameters::excitatoryWeight;
+        const float inhWeight = (float)Parameters::inhibitoryWeight;
+        RaggedMatrix merged;
+        merged.numPre = NumNeurons;
+        merged.numPost = NumLIF;
+        merged.rowStart.assign(1, 0);
+        for(unsigned int i = 0; i < Parameters::numExcitatory; i++) {
+            if(!m_Plastic) {
+                appendRow(merged, ee, i, 0, excWeight);
+            }
+            appendRow(merged, ei, i, Parameters::numExcitatory, excWeight);
+            merged.rowStart.push_back((unsigned int)merged.ind.size());
+        }
+        for(unsigned int i = 0; i < Parameters::numInhibitory; i++) {
+            appendRow(merged, ie, i, 0, inhWeight);
+            appendRow(merged, ii, i, Parameters::numExcitatory, inhWeight);
+            merged.rowStart.push_back((unsigned int)merged.ind.size());
+        }
+        for(unsigned int i = 0; i < Parameters::numPoisson; i++) {
+            appendRow(merged, pe, i, 0, excWeight);
+            appendRow(merged, pi, i, Parameters::numExcitatory, excWeight);
+            merged.rowStart.push_back((unsigned int)merged.ind.size());
+        }
+        splitByDelay(merged, getUniformDelays(merged, Parameters::synapticDelay, m_MaxDelay, 42, DelayStream), m_Static);
+
+        // Plastic synapses also need their columns for postsynaptic learning
+        m_EE.numPre = m_EE.numPost = Parameters::numExcitatory;
+        m_EE.rowStart.assign(1, 0);
+        m_EE.ind.clear();
+        m_EE.g.clear();
+        if(m_Plastic) {
+            for(unsigned int i = 0; i < Parameters::numExcitatory; i++) {
+                appendRow(m_EE, ee, i, 0, excWeight);
+                m_EE.rowStart.push_back((unsigned int)m_EE.ind.size());
+            }
+            buildColumns();
+        }
+        else {
+            // Kept (unchanging) for the weight output
+            m_EE = ee;
+            std::fill(m_EE.g.begin(), m_EE.g.end(), excWeight);
+        }
+
+        printf("%zu static and %zu plastic synapses, static delays of %u-%u timesteps\n", m_Static.getNumSynapses(),
+               m_Plastic ? m_EE.getNumSynapses() : (size_t)0, Parameters::synapticDelay, m_MaxDelay);
+        return true;
+    }
+
+    //! Write the connectivity loadConnectivity built from the .wmat files in
+    //! directory to image, so a later run can start with loadImage instead.
+    //! Returns false if the files can't be identified
+    bool saveImage(Checkpoint::Writer &image, const std::string &directory) const
+    {
+        Trace::Scope trace("Save image", "output");
+
+        std::vector<uint64_t> key;
+        if(!getImageKey(directory, key)) {
+            return false;
+        }
+        image.write("image_key", key);
+        image.write("static_row_segments", m_Static.rowSegments);
+        image.write("static_segment_start", m_Static.segmentStart);
+        image.write("static_segment_delay", m_Static.segmentDelay);
+        image.write("static_segment_pre", m_Static.segmentPre);
+        image.write("static_ind", m_Static.ind);
+        image.write("static_g", m_Static.g);
+        image.write("ee_row_start", m_EE.rowStart);
+        image.write("ee_ind", m_EE.ind);
+        image.write("ee_g", m_EE.g);
+        image.write("col_start", m_ColStart);
+        image.write("col_synapse", m_ColSynapse);
+        image.write("col_pre", m_ColPre);
+        return true;
+    }
+
+    //! Take the connectivity from an image saveImage wrote rather than
+    //! loading it, returning false (leaving the network to be loaded) unless
+    //! it was written with the same options, model parameters and, judged by
+    //! their sizes and modification times, .wmat files in directory
+    bool loadImage(const Checkpoint::Reader &image, const std::string &directory)
+    {
+        Trace::Scope trace("Load image", "loader");
+
+        std::vector<uint64_t> key, imageKey;
+        if(!getImageKey(directory, key) || !image.read("image_key", imageKey) || imageKey != key) {
+            fprintf(stderr, "Image was built from other connectivity or model options\n");
+            return false;
+        }
+        if(!image.read("static_row_segments", m_Static.rowSegments) || !image.read("static_segment_start", m_Static.segmentStart)
+           || !image.read("static_segment_delay", m_Static.segmentDelay) || !image.read("static_segment_pre", m_Static.segmentPre)
+           || !image.read("static_ind", m_Static.ind) || !image.read("static_g", m_Static.g)
+           || !image.read("ee_row_start", m_EE.rowStart) || !image.read("ee_ind", m_EE.ind) || !image.read("ee_g", m_EE.g)
+           || !image.read("col_start", m_ColStart) || !image.read("col_synapse", m_ColSynapse) || !image.read("col_pre", m_ColPre))
+        {
+            return false;
+        }
+        m_Static.numPre = NumNeurons;
+        m_Static.numPost = NumLIF;
+        m_EE.numPre = m_EE.numPost = Parameters::numExcitatory;
+
+        printf("%zu static and %zu plastic synapses, static delays of %u-%u timesteps\n", m_Static.getNumSynapses(),
+               m_Plastic ? m_EE.getNumSynapses() : (size_t)0, Parameters::synapticDelay, m_MaxDelay);
+        return true;
+    }
+
+    //! Advance the network by one timestep
+    void step()
+    {
+        const float t = (float)((double)m_Step * Parameters::timestep);
+
+        // Deliver the static row segments arriving this step, each thread
+        // taking a share of them and accumulating into its own buffer
+        const std::vector<unsigned int> &due = m_StaticQueue.getDue();
+        if(!due.empty()) {
+            m_Pool.parallelFor((unsigned int)due.size(),
+                [this, &due](unsigned int begin, unsigned int end, unsigned int thread)
+                {
+                    if(begin != end) {
+                        deliverStatic(due.data() + begin, due.data() + end, m_Threads[thread]);
+                    }
+                });
+        }
+        m_StaticQueue.clearDue();
+
+        // And the plastic rows of the excitatory spikes emitted synapticDelay + 1 steps ago
+        const std::vector<unsigned int> &duePlastic = m_PlasticQueue.getDue();
+        if(!duePlastic.empty()) {
+            m_Pool.parallelFor((unsigned int)duePlastic.size(),
+                [this, &duePlastic, t](unsigned int begin, unsigned int end, unsigned int thread)
+                {
+                    if(begin != end) {
+                        deliverPlastic(duePlastic.data() + begin, duePlastic.data() + end, t, m_Threads[thread]);
+                    }
+                });
+        }
+        m_PlasticQueue.clearDue();
+
+        // Potentiate the synapses onto excitatory neurons which spiked last step
+        if(m_Plastic) {
+            const std::vector<unsigned int> &last = m_Spikes;
+            const unsigned int numExcSpikes = (unsigned int)(std::lower_bound(last.begin(), last.end(), Parameters::numExcitatory) - last.begin());
+            if(numExcSpikes > 0 && m_Step > 0) {
+                m_Pool.parallelFor(numExcSpikes,
+                    [this, &last, t](unsigned int begin, unsigned int end, unsigned int)
+                    {
+                        for(unsigned int s = begin; s < end; s++) {
+                            learnPost(last[s], t);
+                        }
+                    });
+            }
+        }
+
+        // Update LIF and Poisson neurons, each thread taking a cache line aligned share of both
+        m_Pool.run(
+            [this](unsigned int thread)
+            {
+                const unsigned int numThreads = m_Pool.getNumThreads();
+                ThreadState &state = m_Threads[thread];
+                const unsigned int lifBegin = ThreadPool::getChunkBoundary(NumLIF, numThreads, 16, thread);
+                const unsigned int lifEnd = ThreadPool::getChunkBoundary(NumLIF, numThreads, 16, thread + 1);
+                gatherInput(lifBegin, lifEnd);
+                state.numSpikes = LIFKernels::updateDelta(m_ISA, m_KernelParams, m_V.data(), m_RefracTime.data(),
+                                                          m_InSyn.data(), lifBegin, lifEnd, state.spikes.data());
+
+                const unsigned int poissonBegin = ThreadPool::getChunkBoundary(Parameters::numPoisson, numThreads, 16, thread);
+                const unsigned int poissonEnd = ThreadPool::getChunkBoundary(Parameters::numPoisson, numThreads, 16, thread + 1);
+                updatePoisson(poissonBegin, poissonEnd, state);
+            });
+
+        // LIF spikes then Poisson spikes, both in ascending order
+        m_Spikes.clear();
+        for(auto &s : m_Threads) {
+            m_Spikes.insert(m_Spikes.end(), s.spikes.begin(), s.spikes.begin() + s.numSpikes);
+            s.numSpikes = 0;
+            s.hasInput = false;
+        }
+        for(auto &s : m_Threads) {
+            m_Spikes.insert(m_Spikes.end(), s.poissonSpikes.begin(), s.poissonSpikes.end());
+            s.poissonSpikes.clear();
+        }
+        for(unsigned int pre : m_Spikes) {
+            m_StaticQueue.push(m_Static, pre);
+            if(m_Plastic && pre < Parameters::numExcitatory) {
+                m_PlasticQueue.push(pre, Parameters::synapticDelay);
+            }
+        }
+        m_StaticQueue.advance();
+        m_PlasticQueue.advance();
+        m_Step++;
+    }
+
+    void setLambda(float lambda){ m_Lambda = lambda; }
+    void setUseDecayTable(bool useDecayTable){ m_UseDecayTable = useDecayTable; }
+
+    //! Load the .wmat files through shared memory segments that concurrent
+    //! benchmark processes can map rather than parse (see SharedConnectivity)
+    void setSharedConnectivity(bool sharedConnectivity){ m_SharedConnectivity = sharedConnectivity; }
+
+    //! Key of the Philox stream of Poisson input, PoissonSeed by default
+    void setPoissonSeed(uint32_t seed){ m_PoissonSeed = seed; }
+    LIFKernels::ISA getISA() const{ return m_ISA; }
+
+    //! Neurons which spiked in the last step (E, I then Poisson), in ascending order
+    const std::vector<unsigned int> &getSpikes() const{ return m_Spikes; }
+
+    //! E->E weights in row order, as GeNN writes them to Weights.bin
+    const std::vector<float> &getEEWeights() const{ return m_EE.g; }
+
+    //! Steps simulated so far, including those before a restored checkpoint
+    unsigned long long getStep() const{ return m_Step; }
+
+    //! Write everything that evolves during a run to checkpoint: neuron
+    //! state, the row segments and plastic rows in flight, the last step's
+    //! spikes and the step count, which with the seed is the whole state of
+    //! the counter-based Poisson RNG, the synaptic event count and, when
+    //! plastic, the E->E weights and STDP traces. Connectivity is rebuilt
+    //! from the .wmat files instead
+    void saveState(Checkpoint::Writer &checkpoint) const
+    {
+        Trace::Scope trace("Save checkpoint", "output");
+
+        checkpoint.write("brunel_config", getConfig());
+        checkpoint.writeValue("step", m_Step);
+        checkpoint.writeValue("poisson_seed", m_PoissonSeed);
+        checkpoint.writeValue("num_events", getNumSynapticEvents());
+        checkpoint.write("v", m_V);
+        checkpoint.write("refrac_time", m_RefracTime);
+        checkpoint.write("in_syn", m_InSyn);
+        checkpoint.write("spikes", m_Spikes);
+        checkpoint.write("static_queue", m_StaticQueue.getState());
+        checkpoint.write("plastic_queue", m_PlasticQueue.getState());
+        if(m_Plastic) {
+            checkpoint.write("ee_g", m_EE.g);
+            checkpoint.write("pre_trace", m_PreTrace);
+            checkpoint.write("pre_update_time", m_PreUpdateTime);
+            checkpoint.write("post_trace", m_PostTrace);
+            checkpoint.write("post_update_time", m_PostUpdateTime);
+        }
+    }
+
+    //! Restore the state saveState wrote into a network constructed and
+    //! loaded with the same options, returning false if it doesn't match
+    bool loadState(const Checkpoint::Reader &checkpoint)
+    {
+        Trace::Scope trace("Load checkpoint", "loader");
+
+        std::vector<unsigned int> config, staticQueue, plasticQueue;
+        unsigned long long numEvents;
+        if(!checkpoint.read("brunel_config", config) || config != getConfig()) {
+            fprintf(stderr, "Checkpoint is of a network with different plasticity or delays\n");
+            return false;
+        }
+        if(!checkpoint.readValue("step", m_Step) || !checkpoint.readValue("poisson_seed", m_PoissonSeed)
+           || !checkpoint.readValue("num_events", numEvents)
+           || !checkpoint.read("v", m_V.data(), m_V.size()) || !checkpoint.read("refrac_time", m_RefracTime.data(), m_RefracTime.size())
+           || !checkpoint.read("in_syn", m_InSyn.data(), m_InSyn.size()) || !checkpoint.read("spikes", m_Spikes)
+           || !checkpoint.read("static_queue", staticQueue) || !checkpoint.read("plastic_queue", plasticQueue)
+           || !m_StaticQueue.setState(staticQueue) || !m_PlasticQueue.setState(plasticQueue))
+        {
+            return false;
+        }
+        for(auto &t : m_Threads) {
+            t.numEvents = 0;
+        }
+        m_Threads[0].numEvents = numEvents;
+        if(m_Plastic) {
+            return checkpoint.read("ee_g", m_EE.g.data(), m_EE.g.size())
+                && checkpoint.read("pre_trace", m_PreTrace.data(), m_PreTrace.size())
+                && checkpoint.read("pre_update_time", m_PreUpdateTime.data(), m_PreUpdateTime.size())
+                && checkpoint.read("post_trace", m_PostTrace.data(), m_PostTrace.size())
+                && checkpoint.read("post_update_time", m_PostUpdateTime.data(), m_PostUpdateTime.size());
+        }
+        return true;
+    }
+
+    //! Number of synaptic events delivered so far
+    unsigned long long getNumSynapticEvents() const
+    {
+        unsigned long long numEvents = 0;
+        for(const auto &t : m_Threads) {
+            numEvents += t.numEvents;
+        }
+        return numEvents;
+    }
+
+    //------------------------------------------------------------------------
+    // Static constants
+    //------------------------------------------------------------------------
+    static const unsigned int NumLIF = Parameters::numNeurons;
+    static const unsigned int NumNeurons = NumLIF + Parameters::numPoisson;
+
+    // LIF parameters as in genn/model.cc
+    static constexpr float TauM = 20.0f;
+    static constexpr float Ioffset = 0.0f;
+    static constexpr float TauRefrac = 0.0f;
+
+    // PoissonNew firing rate [Hz] as in genn/model.cc
+    static constexpr float PoissonRate = 20.0f;
+    static constexpr uint32_t PoissonSeed = 42;
+
+    // Philox stream of the static synaptic delays
+    static const uint32_t DelayStream = 4;
+
+    // Changed whenever the sections of an image are
+    static const uint64_t ImageVersion = 1;
+
+    // STDPWeightDependent parameters as in genn/model.cc
+    static constexpr float TauPlus = 20.0f;
+    static constexpr float TauMinus = 20.0f;
+    static constexpr float APlus = 1.0f;
+    static constexpr float AMinus = 1.0f;
+    static constexpr float WMin = 0.0f;
+    static constexpr float WMax = 0.3f;
+    static constexpr float Alpha = 2.02f;
+
+private:
+    //------------------------------------------------------------------------
+    // ThreadState
+    //------------------------------------------------------------------------
+    struct ThreadState
+    {
+        std::vector<float> inSyn;
+        // LIF spikes of this thread's chunk, sized for the kernels' compress-stores
+        std::vector<unsigned int> spikes;
+        unsigned int numSpikes;
+        std::vector<unsigned int> poissonSpikes;
+        std::vector<float> poissonUniforms;
+        bool hasInput;
+        unsigned long long numEvents;
+    };
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    //! What a checkpoint must match to be restored into this network
+    std::vector<unsigned int> getConfig() const
+    {
+        return {m_Plastic ? 1u : 0u, m_MaxDelay, NumNeurons, (unsigned int)m_Static.getNumSynapses(),
+                (unsigned int)m_EE.getNumSynapses()};
+    }
+
+    //! What an image must match to stand in for loading from directory: the
+    //! options and model parameters that shape the connectivity, then the
+    //! stamp of each .wmat file
+    bool getImageKey(const std::string &directory, std::vector<uint64_t> &key) const
+    {
+        const double weights[2] = {Parameters::excitatoryWeight, Parameters::inhibitoryWeight};
+        uint64_t weightBits[2];
+        memcpy(weightBits, weights, sizeof(weights));
+        key = {ImageVersion, m_Plastic ? 1u : 0u, m_MaxDelay, Parameters::numExcitatory, Parameters::numInhibitory,
+               Parameters::numPoisson, Parameters::synapticDelay, weightBits[0], weightBits[1]};
+        for(const char *name : {"/ee.wmat", "/ei.wmat", "/ie.wmat", "/ii.wmat"}) {
+            if(!Checkpoint::appendFileStamp(directory + name, key)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool loadWmatFile(const std::string &filename, RaggedMatrix &matrix) const
+    {
+        return m_SharedConnectivity ? SharedConnectivity::loadWmat(filename, matrix) : loadWmat(filename, matrix);
+    }
+
+    //! Fixed number of random (possibly repeated) targets per row, generated
+    //! with rand() exactly as genn/matLoader.h's random_connectivity
+    static void randomConnectivity(unsigned int numPost, unsigned int rowLength, int seed, RaggedMatrix &matrix)
+    {
+        matrix.numPre = Parameters::numPoisson;
+        matrix.numPost = numPost;
+        matrix.rowStart.resize(Parameters::numPoisson + 1);
+        matrix.ind.resize(Parameters::numPoisson * rowLength);
+        srand(seed);
+        for(unsigned int i = 0; i < Parameters::numPoisson; i++) {
+            matrix.rowStart[i] = i * rowLength;
+            for(unsigned int s = 0; s < rowLength; s++) {
+                matrix.ind[(i * rowLength) + s] = rand() % numPost;
+            }
+        }
+        matrix.rowStart[Parameters::numPoisson] = Parameters::numPoisson * rowLength;
+    }
+
+    static void appendRow(RaggedMatrix &target, const RaggedMatrix &matrix, unsigned int pre, unsigned int postOffset,
+                          float weight)
+    {
+        for(unsigned int j = matrix.rowStart[pre]; j < matrix.rowStart[pre + 1]; j++) {
+            target.ind.push_back(matrix.ind[j] + postOffset);
+            target.g.push_back(weight);
+        }
+    }
+
+    void buildColumns()
+    {
+        m_ColStart.assign(Parameters::numExcitatory + 1, 0);
+        for(unsigned int post : m_EE.ind) {
+            m_ColStart[post + 1]++;
+        }
+        for(unsigned int i = 0; i < Parameters::numExcitatory; i++) {
+            m_ColStart[i + 1] += m_ColStart[i];
+        }
+
+        std::vector<unsigned int> fill(m_ColStart.begin(), m_ColStart.end() - 1);
+        m_ColSynapse.resize(m_EE.getNumSynapses());
+        m_ColPre.resize(m_EE.getNumSynapses());
+        for(unsigned int pre = 0; pre < Parameters::numExcitatory; pre++) {
+            for(unsigned int j = m_EE.rowStart[pre]; j < m_EE.rowStart[pre + 1]; j++) {
+                const unsigned int c = fill[m_EE.ind[j]]++;
+                m_ColSynapse[c] = j;
+                m_ColPre[c] = pre;
+            }
+        }
+    }
+
+    //! Add the weights of each arriving static row segment to the thread's input buffer
+    void deliverStatic(const unsigned int *begin, const unsigned int *end, ThreadState &state)
+    {
+        state.hasInput = true;
+        float *inSyn = state.inSyn.data();
+        for(const unsigned int *s = begin; s != end; s++) {
+            const unsigned int segmentEnd = m_Static.segmentStart[*s + 1];
+            for(unsigned int j = m_Static.segmentStart[*s]; j < segmentEnd; j++) {
+                inSyn[m_Static.ind[j]] += m_Static.g[j];
+            }
+            state.numEvents += segmentEnd - m_Static.segmentStart[*s];
+        }
+    }
+
+    //! Add the weights of each spiking excitatory neuron's plastic synapses to
+    //! the thread's input buffer, depressing them as STDPWeightDependent's sim code
+    void deliverPlastic(const unsigned int *begin, const unsigned int *end, float t, ThreadState &state)
+    {
+        state.hasInput = true;
+        float *inSyn = state.inSyn.data();
+        const float depression = m_Lambda * Alpha;
+        for(const unsigned int *s = begin; s != end; s++) {
+            // Only this thread handles pre's spike, so its trace and row are ours to update
+            const unsigned int pre = *s;
+            m_PreTrace[pre] = (m_PreTrace[pre] * getPlusDecay(t - m_PreUpdateTime[pre])) + APlus;
+            m_PreUpdateTime[pre] = t;
+
+            const unsigned int eeEnd = m_EE.rowStart[pre + 1];
+            for(unsigned int j = m_EE.rowStart[pre]; j < eeEnd; j++) {
+                const unsigned int post = m_EE.ind[j];
+                const float g = m_EE.g[j];
+                inSyn[post] += g;
+
+                const float postTrace = m_PostTrace[post] * getMinusDecay(t - m_PostUpdateTime[post]);
+                const float newWeight = g - (depression * g * postTrace);
+                m_EE.g[j] = (newWeight < WMin) ? WMin : newWeight;
+            }
+            state.numEvents += eeEnd - m_EE.rowStart[pre];
+        }
+    }
+
+    //! STDPWeightDependent's learn post code for every synapse onto post
+    void learnPost(unsigned int post, float t)
+    {
+        m_PostTrace[post] = (m_PostTrace[post] * getMinusDecay(t - m_PostUpdateTime[post])) + AMinus;
+        m_PostUpdateTime[post] = t;
+
+        for(unsigned int c = m_ColStart[post]; c < m_ColStart[post + 1]; c++) {
+            const unsigned int pre = m_ColPre[c];
+            const float preTrace = m_PreTrace[pre] * getPlusDecay(t - m_PreUpdateTime[pre]);
+            float &g = m_EE.g[m_ColSynapse[c]];
+            const float newWeight = g + (m_Lambda * (WMax - g) * preTrace);
+            g = (newWeight > WMax) ? WMax : newWeight;
+        }
+    }
+
+    float getPlusDecay(float elapsed) const
+    {
+        return m_UseDecayTable ? m_PlusDecay.get(elapsed) : std::exp(-elapsed / TauPlus);
+    }
+
+    float getMinusDecay(float elapsed) const
+    {
+        return m_UseDecayTable ? m_MinusDecay.get(elapsed) : std::exp(-elapsed / TauMinus);
+    }
+
+    //! Add the input every thread accumulated for neurons [begin, end)
+    //! and clear it ready for the next step
+    void gatherInput(unsigned int begin, unsigned int end)
+    {
+        for(auto &t : m_Threads) {
+            if(!t.hasInput) {
+                continue;
+            }
+            for(unsigned int i = begin; i < end; i++) {
+                m_InSyn[i] += t.inSyn[i];
+                t.inSyn[i] = 0.0f;
+            }
+        }
+    }
+
+    //! GeNN's PoissonNew as a Bernoulli trial per neuron and step. The
+    //! uniforms come from Philox value i of step m_Step so no per-neuron
+    //! state is kept and the spikes don't depend on the thread count
+    void updatePoisson(unsigned int begin, unsigned int end, ThreadState &state)
+    {
+        state.poissonUniforms.resize(end - begin);
+        Philox::fillUniform(m_PoissonSeed, 0, m_Step, begin, end - begin, state.poissonUniforms.data(), m_ISA);
+        for(unsigned int i = begin; i < end; i++) {
+            if(state.poissonUniforms[i - begin] <= m_PoissonThreshold) {
+                state.poissonSpikes.push_back(NumLIF + i);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const bool m_Plastic;
+    const LIFKernels::ISA m_ISA;
+    LIFKernels::DeltaParams m_KernelParams;
+    ThreadPool &m_Pool;
+
+    // LIF state
+    std::vector<float> m_V;
+    std::vector<float> m_RefracTime;
+    std::vector<float> m_InSyn;
+
+    // Poisson spike probability per step
+    float m_PoissonThreshold;
+
+    // Connectivity
+    DelayedMatrix m_Static;
+    RaggedMatrix m_EE;
+    std::vector<unsigned int> m_ColStart;
+    std::vector<unsigned int> m_ColSynapse;
+    std::vector<unsigned int> m_ColPre;
+
+    // STDP traces of excitatory neurons and when they were last updated [ms]
+    std::vector<float> m_PreTrace;
+    std::vector<float> m_PreUpdateTime;
+    std::vector<float> m_PostTrace;
+    std::vector<float> m_PostUpdateTime;
+
+    // Static row segments and plastic rows in flight
+    const unsigned int m_MaxDelay;
+    DelayQueue m_StaticQueue;
+    DelayQueue m_PlasticQueue;
+
+    // Spikes emitted in the last step
+    std::vector<unsigned int> m_Spikes;
+    unsigned long long m_Step;
+    uint32_t m_PoissonSeed;
+
+    std::vector<ThreadState> m_Threads;
+    float m_Lambda;
+
+    // Looked up trace decays
+    bool m_UseDecayTable;
+    const DecayTable m_PlusDecay;
+    const DecayTable m_MinusDecay;
+
+    // Load .wmat files through SharedConnectivity
+    bool m_SharedConnectivity;
+};
+} // SNNBench
@@ -0,0 +1,48 @@
+#!/bin/bash
+# Checks that a plastic run killed after a checkpoint and resumed with
+# --restore leaves exactly the outputs of an uninterrupted run. Needs the
+# simulator built and the connectivity (../*.wmat) created
+# Usage: ./checkpoint_check.sh [simtime] [checkpoint_every]
+set -e
+
+SIMTIME=${1:-0.2}
+CHECKPOINT_EVERY=${2:-0.1}
+SIMULATOR=$(cd "$(dirname "$0")" && pwd)/simulator
+BRUNEL=$(cd "$(dirname "$0")/.." && pwd)
+OPTIONS="--plastic --weight_every 10 --weight_encoding delta --hist_every 10"
+OUTPUTS="spikes.csv inh_spikes.csv pois_spikes.csv weight_stream.bin weight_hist.tsv Weights.bin"
+
+# Both runs load ../*.wmat from their own directory
+SCRATCH=$(mktemp -d)
+trap 'rm -rf "$SCRATCH"' EXIT
+for f in ee ei ie ii; do ln -s "$BRUNEL/$f.wmat" "$SCRATCH/$f.wmat"; done
+mkdir "$SCRATCH/uninterrupted" "$SCRATCH/resumed"
+
+(cd "$SCRATCH/uninterrupted" && "$SIMULATOR" --simtime $SIMTIME $OPTIONS > log.txt)
+
+# Kill the second run a little after its first checkpoint, well before its next
+cd "$SCRATCH/resumed"
+"$SIMULATOR" --simtime 1000 $OPTIONS --checkpoint_every $CHECKPOINT_EVERY > killed_log.txt &
+PID=$!
+while [ ! -f checkpoint.bin ]; do
+    if ! kill -0 $PID 2> /dev/null; then
+        echo "Run exited before checkpointing"
+        exit 1
+    fi
+    sleep 0.01
+done
+sleep 0.2
+kill -9 $PID
+wait $PID 2> /dev/null || true
+"$SIMULATOR" --simtime $SIMTIME $OPTIONS --restore checkpoint.bin > log.txt
+
+STATUS=0
+for f in $OUTPUTS; do
+    if cmp -s "$f" "../uninterrupted/$f"; then
+        echo "$f: identical"
+    else
+        echo "$f: DIFFERS from the uninterrupted run"
+        STATUS=1
+    fi
+done
+exit $STATUS
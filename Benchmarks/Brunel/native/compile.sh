@@ -0,0 +1,29 @@
+# The native engine has no dependencies beyond a C++11 compiler
+# Connectivity (../*.wmat) must first be created with ../createConnectivity.sh
+make -j8
+
+# In order to run the model on 8 threads with STDP;
+# ./simulator --simtime 100.0 --fast --plastic --num_threads 8
+
+# Checkpointing every 10s of simulated time, then resuming a killed run;
+# ./simulator --simtime 100.0 --fast --plastic --checkpoint_every 10.0
+# ./simulator --simtime 100.0 --fast --plastic --restore checkpoint.bin
+
+# Checking that a run killed after a checkpoint resumes to the same outputs;
+# make check
+
+# Saving the loaded connectivity on the first run, so later runs skip loading;
+# ./simulator --simtime 100.0 --fast --plastic --image brunel_plastic.img
+
+# Streaming E->E weight snapshots every 100ms to weight_stream.bin;
+# ./simulator --simtime 100.0 --fast --plastic --weight_every 100 --weight_encoding delta
+
+# Logging a histogram of the E->E weights every 100ms to weight_hist.tsv;
+# ./simulator --simtime 100.0 --fast --plastic --hist_every 100
+
+# Aborting as soon as the E or I rate over 100ms leaves 0.1-1000Hz;
+# ./simulator --simtime 100.0 --fast --plastic --rate_watchdog 0.1,1000
+
+# Cost of exp against table lookups of the STDP trace decays, and the
+# E->E weight drift between them over a 100s plastic run;
+# ./stdp_decay_check --simtime 100.0 --num_threads 8
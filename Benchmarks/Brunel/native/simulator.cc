@@ -0,0 +1,435 @@
+// Standard C++ includes
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+
+// GeNN robotics includes
+#include "../genn/timer.h"
+
+// Shared benchmark utilities
+#include "../../common/fork_trials.h"
+#include "../../common/rate_watchdog.h"
+#include "../../common/thread_pool.h"
+#include "../../common/trace.h"
+#include "../../common/weight_histogram.h"
+#include "../../common/weight_monitor.h"
+
+// Native model
+#include "brunel_network.h"
+
+#include <getopt.h>
+
+using namespace BoBRobotics;
+using namespace SNNBench;
+
+int main (int argc, char *argv[])
+{
+    // Getting options:
+    float simtime = 20.0;
+    bool fast = false;
+    bool plastic = false;
+    float lambda = 0.01f;
+    unsigned int trace_every = 0;
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    std::string isa = "auto";
+    LIFKernels::Integrator integrator = LIFKernels::Integrator::Euler;
+    bool decay_table = false;
+    unsigned int max_timesteps_delay = 0;
+    unsigned int trials = 0;
+    bool shared_connectivity = false;
+    bool trial_seeds = false;
+    float checkpoint_every = 0.0f;
+    std::string checkpoint_file = "checkpoint.bin";
+    std::string restore_file;
+    std::string image_file;
+    float weight_every = 0.0f;
+    std::string weight_file = "weight_stream.bin";
+    WeightMonitor::Encoding weight_encoding = WeightMonitor::Encoding::Full;
+    float hist_every = 0.0f;
+    unsigned int hist_bins = 100;
+    float min_rate = 0.0f, max_rate = 0.0f;
+    float rate_window = 100.0f;
+    const char* const short_opts = "";
+    const option long_opts[] = {
+      {"simtime", 1, nullptr, 0},
+      {"fast", 0, nullptr, 1},
+      {"plastic", 0, nullptr, 2},
+      {"trace", 0, nullptr, 3},
+      {"trace_every", 1, nullptr, 4},
+      {"num_threads", 1, nullptr, 5},
+      {"lambda", 1, nullptr, 6},
+      {"isa", 1, nullptr, 7},
+      {"integrator", 1, nullptr, 8},
+      {"stdp_decay", 1, nullptr, 9},
+      {"max_timesteps_delay", 1, nullptr, 10},
+      {"trials", 1, nullptr, 11},
+      {"trial_seeds", 0, nullptr, 12},
+      {"shared_connectivity", 0, nullptr, 13},
+      {"checkpoint_every", 1, nullptr, 14},
+      {"checkpoint", 1, nullptr, 15},
+      {"restore", 1, nullptr, 16},
+      {"image", 1, nullptr, 17},
+      {"weight_every", 1, nullptr, 18},
+      {"weight_file", 1, nullptr, 19},
+      {"weight_encoding", 1, nullptr, 20},
+      {"hist_every", 1, nullptr, 21},
+      {"hist_bins", 1, nullptr, 22},
+      {"rate_watchdog", 1, nullptr, 23},
+      {"rate_window", 1, nullptr, 24},
+      {nullptr, 0, nullptr, 0}
+    };
+    // Check the set of options
+    while (true) {
+      const auto opt = getopt_long(argc, argv, short_opts, long_opts, nullptr);
+
+      // If none
+      if (-1 == opt) break;
+
+      switch (opt){
+        case 0:
+          printf("Running with a simulation time of: %ss\n", optarg);
+          simtime = std::stof(optarg);
+          break;
+        case 1:
+          printf("Running in fast mode (no spike collection)\n");
+          fast = true;
+          break;
+        case 2:
+          printf("Running with STDP on the E->E synapses\n");
+          plastic = true;
+          break;
+        case 3:
+          printf("Writing a chrome://tracing timeline to trace.json\n");
+          Trace::enable();
+          break;
+        case 4:
+          printf("Tracing every %s simulation steps\n", optarg);
+          trace_every = std::stoi(optarg);
+          Trace::enable();
+          break;
+        case 5:
+          num_threads = std::stoi(optarg);
+          break;
+        case 6:
+          printf("Learning rate: %s\n", optarg);
+          lambda = std::stof(optarg);
+          break;
+        case 7:
+          // Neuron update kernel: scalar, avx2, avx512 or auto (the widest this CPU supports)
+          isa = optarg;
+          break;
+        case 8:
+          if (!LIFKernels::selectIntegrator(optarg, integrator)) {
+            fprintf(stderr, "Unknown integrator '%s' (expected euler or exact)\n", optarg);
+            return 1;
+          }
+          break;
+        case 9:
+          // STDP trace decay: exp (as GeNN) or table (looked up by elapsed timesteps)
+          if (std::string(optarg) != "exp" && std::string(optarg) != "table") {
+            fprintf(stderr, "Unknown STDP decay '%s' (expected exp or table)\n", optarg);
+            return 1;
+          }
+          decay_table = (std::string(optarg) == "table");
+          break;
+        case 10:
+          // Each static synapse's delay is drawn uniformly from [synapticDelay, max_timesteps_delay]
+          max_timesteps_delay = std::stoi(optarg);
+          break;
+        case 11:
+          printf("Running %s forked trials from the loaded network (no spike collection)\n", optarg);
+          trials = std::stoi(optarg);
+          break;
+        case 12:
+          printf("Seeding each trial's Poisson input differently\n");
+          trial_seeds = true;
+          break;
+        case 13:
+          printf("Loading connectivity through shared memory segments\n");
+          shared_connectivity = true;
+          break;
+        case 14:
+          printf("Checkpointing every %ss of simulated time\n", optarg);
+          checkpoint_every = std::stof(optarg);
+          break;
+        case 15:
+          checkpoint_file = optarg;
+          break;
+        case 16:
+          printf("Restoring the network state from: %s\n", optarg);
+          restore_file = optarg;
+          break;
+        case 17:
+          printf("Post-initialisation image: %s\n", optarg);
+          image_file = optarg;
+          break;
+        case 18:
+          printf("Streaming E->E weight snapshots every %sms\n", optarg);
+          weight_every = std::stof(optarg);
+          break;
+        case 19:
+          weight_file = optarg;
+          break;
+        case 20:
+          if (std::string(optarg) == "full") weight_encoding = WeightMonitor::Encoding::Full;
+          else if (std::string(optarg) == "delta") weight_encoding = WeightMonitor::Encoding::Delta;
+          else {
+            fprintf(stderr, "Unknown weight encoding '%s' (full or delta)\n", optarg);
+            return 1;
+          }
+          printf("Weight snapshot encoding: %s\n", optarg);
+          break;
+        case 21:
+          printf("Logging E->E weight histograms every %sms to weight_hist.tsv\n", optarg);
+          hist_every = std::stof(optarg);
+          break;
+        case 22:
+          printf("Weight histogram bins: %s\n", optarg);
+          hist_bins = std::stoi(optarg);
+          break;
+        case 23:
+          if (!RateWatchdog::parseBand(optarg, min_rate, max_rate)) {
+            fprintf(stderr, "Rate watchdog band '%s' is not MIN,MAX in Hz\n", optarg);
+            return 1;
+          }
+          printf("Aborting if E or I rates leave [%g, %g]Hz\n", min_rate, max_rate);
+          break;
+        case 24:
+          printf("Rate watchdog window: %sms\n", optarg);
+          rate_window = std::stof(optarg);
+          break;
+        default:
+          break;
+      }
+    };
+    printf("Running on %u threads\n", std::max(1u, num_threads));
+
+    ThreadPool pool(num_threads);
+    BrunelNetwork network(plastic, max_timesteps_delay, pool, integrator, LIFKernels::select(isa));
+    printf("Neuron update kernel: %s, %s integration\n", LIFKernels::getName(network.getISA()), LIFKernels::getName(integrator));
+    network.setSharedConnectivity(shared_connectivity);
+    network.setLambda(lambda);
+    network.setUseDecayTable(decay_table);
+    if (plastic) printf("STDP trace decay: %s\n", decay_table ? "table" : "exp");
+
+    // Loading Synapses, from the post-initialisation image of an earlier run if it is still valid
+    {
+        Timer<> t("Synapse setup:");
+        Trace::Scope s("Synapse setup");
+        bool loaded = false;
+        if (!image_file.empty() && access(image_file.c_str(), F_OK) == 0) {
+          const Checkpoint::Reader image(image_file);
+          loaded = image.isValid() && network.loadImage(image, "..");
+        }
+        if (!loaded) {
+          if (!network.loadConnectivity("..")) return 1;
+          if (!image_file.empty()) {
+            Checkpoint::Writer image(image_file);
+            if (network.saveImage(image, "..") && image.finish()) printf("Wrote %.1fMB image to %s\n", (double)image.getNumBytes() / (1024.0 * 1024.0), image_file.c_str());
+          }
+        }
+    }
+
+    // Output files whose sizes each checkpoint records, so a restored run
+    // can cut them back to that point rather than repeat what was written
+    // after it, and the weight stream and histogram state that go with them
+    const unsigned int weight_steps = (unsigned int)std::round(weight_every / Parameters::timestep);
+    const unsigned int hist_steps = (unsigned int)std::round(hist_every / Parameters::timestep);
+    struct Output { const char *section; std::string filename; bool written; };
+    const std::vector<Output> outputs = {
+      {"spikes_bytes", "spikes.csv", !fast},
+      {"inh_spikes_bytes", "inh_spikes.csv", !fast},
+      {"pois_spikes_bytes", "pois_spikes.csv", !fast},
+      {"weight_stream_bytes", weight_file, weight_steps > 0},
+      {"weight_hist_bytes", "weight_hist.tsv", hist_steps > 0}};
+    std::set<std::string> continued;
+    std::vector<unsigned long long> weight_records;
+    std::vector<float> weight_reference, hist_shift;
+
+    // Continue a run from a checkpoint of the same configuration
+    if (!restore_file.empty()) {
+        Timer<> t("Checkpoint restore:");
+        const Checkpoint::Reader checkpoint(restore_file);
+        if (!checkpoint.isValid() || !network.loadState(checkpoint)) return 1;
+        for (const Output &o : outputs) {
+          uint64_t size;
+          if (!checkpoint.hasSection(o.section)) continue;
+          if (!checkpoint.readValue(o.section, size) || !Checkpoint::truncateFile(o.filename, size)) return 1;
+          continued.insert(o.filename);
+        }
+        if (checkpoint.hasSection("weight_records")
+            && (!checkpoint.read("weight_records", weight_records) || !checkpoint.read("weight_reference", weight_reference))) return 1;
+        if (checkpoint.hasSection("weight_hist_shift") && !checkpoint.read("weight_hist_shift", hist_shift)) return 1;
+        printf("Restored the state at %.4fs of simulated time\n", (double)network.getStep() * Parameters::timestep / 1000.0);
+    }
+
+    // Each trial times the simulation in a child forked from the loaded network
+    if (trials > 0) {
+      const std::vector<ForkTrials::Result> results = ForkTrials::run(trials, pool,
+          [&network, simtime, trial_seeds](unsigned int trial)
+          {
+            if (trial_seeds) network.setPoissonSeed(BrunelNetwork::PoissonSeed + trial);
+            const auto starttime = std::chrono::steady_clock::now();
+            for (unsigned int t = 0; t < (unsigned int)(simtime*10000); t++) network.step();
+            const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - starttime;
+            return ForkTrials::Result{true, duration.count(), (double)network.getNumSynapticEvents()};
+          });
+      return ForkTrials::report(results, "trialsfile.dat") ? 0 : 1;
+    }
+
+    // Spike files as written by the GeNN simulator, continued by a restored run
+    std::ofstream spikes, i_spikes, p_spikes;
+    if (!fast) {
+      std::ofstream *files[3] = {&spikes, &i_spikes, &p_spikes};
+      for (unsigned int i = 0; i < 3; i++) {
+        const bool append = (continued.count(outputs[i].filename) > 0);
+        files[i]->precision(16);
+        files[i]->open(outputs[i].filename, append ? std::ios::app : std::ios::out);
+        if (!append) *files[i] << "Time [ms], Neuron ID" << std::endl;
+      }
+    }
+
+    // E->E weight snapshots, written on a background thread
+    std::unique_ptr<WeightMonitor> weight_monitor;
+    if (weight_steps > 0) {
+      weight_monitor.reset(new WeightMonitor(weight_file, network.getEEWeights().size(), weight_encoding, continued.count(weight_file) > 0));
+      if (!weight_monitor->isOpen()) return 1;
+      if (!weight_records.empty()) weight_monitor->setState(weight_records[0], weight_reference);
+    }
+
+    // E->E weight histograms between the STDP weight bounds
+    std::unique_ptr<WeightHistogram::Logger> weight_hist;
+    if (hist_steps > 0) {
+      weight_hist.reset(new WeightHistogram::Logger("weight_hist.tsv", WeightHistogram::Binning(BrunelNetwork::WMin, BrunelNetwork::WMax, hist_bins),
+                                                    pool, network.getISA(), continued.count("weight_hist.tsv") > 0));
+      if (!weight_hist->isOpen()) return 1;
+      if (!hist_shift.empty()) weight_hist->setShift(hist_shift[0]);
+    }
+
+    // Stops runaway or silent runs, even in fast mode
+    const bool watch_rates = (max_rate > 0.0f);
+    RateWatchdog watchdog(min_rate, max_rate, rate_window, Parameters::timestep);
+    watchdog.addPopulation("E", Parameters::numExcitatory);
+    watchdog.addPopulation("I", Parameters::numInhibitory);
+
+    // Wall clock time, as clock() would add up the CPU time of every thread,
+    // less the time spent writing checkpoints
+    double totaltime;
+    double checkpointtime = 0.0;
+    {
+        Timer<> t("Simulation:");
+        Trace::Scope s("Simulation", "simulation");
+        // Loop through timesteps
+        int timesteps_per_second = 10000;
+        const unsigned int checkpoint_steps = (unsigned int)(checkpoint_every*timesteps_per_second);
+        const auto starttime = std::chrono::steady_clock::now();
+        for(unsigned int t = (unsigned int)network.getStep(); t < (unsigned int)(simtime*timesteps_per_second); t++)
+        {
+            const bool trace_step = Trace::shouldTraceStep(t, trace_every);
+            Trace::Scope step("Step", "simulation", trace_step);
+
+            network.step();
+
+            if (!fast) {
+                Trace::Scope record("Record spikes", "recording", trace_step);
+                for (unsigned int id : network.getSpikes()) {
+                  if (id < Parameters::numExcitatory) spikes << t << "," << id << std::endl;
+                  else if (id < BrunelNetwork::NumLIF) i_spikes << t << "," << (id - Parameters::numExcitatory) << std::endl;
+                  else p_spikes << t << "," << (id - BrunelNetwork::NumLIF) << std::endl;
+                }
+            }
+
+            if (weight_steps > 0 && ((t + 1) % weight_steps) == 0) {
+                weight_monitor->record(t + 1, network.getEEWeights().data());
+            }
+
+            if (watch_rates) {
+                unsigned int num_exc = 0, num_inh = 0;
+                for (unsigned int id : network.getSpikes()) {
+                  if (id < Parameters::numExcitatory) num_exc++;
+                  else if (id < BrunelNetwork::NumLIF) num_inh++;
+                }
+                watchdog.addSpikes(0, num_exc);
+                watchdog.addSpikes(1, num_inh);
+                if (!watchdog.endStep()) {
+                  watchdog.printDiagnostic();
+                  return 2;
+                }
+            }
+
+            if (hist_steps > 0 && ((t + 1) % hist_steps) == 0) {
+                const std::vector<float> &weights = network.getEEWeights();
+                weight_hist->record((double)(t + 1) * Parameters::timestep, weights.data(), weights.size());
+            }
+
+            if (checkpoint_steps > 0 && ((t + 1) % checkpoint_steps) == 0) {
+                const auto checkpointstart = std::chrono::steady_clock::now();
+                for (auto *f : {&spikes, &i_spikes, &p_spikes}) f->flush();
+                if (weight_monitor && !weight_monitor->flush()) return 1;
+                if (weight_hist && !weight_hist->flush()) return 1;
+                Checkpoint::Writer checkpoint(checkpoint_file);
+                network.saveState(checkpoint);
+                for (const Output &o : outputs) {
+                  uint64_t size;
+                  if (!o.written) continue;
+                  if (!Checkpoint::getFileSize(o.filename, size)) return 1;
+                  checkpoint.writeValue(o.section, size);
+                }
+                if (weight_monitor) {
+                  checkpoint.writeValue("weight_records", weight_monitor->getNumRecords());
+                  checkpoint.write("weight_reference", weight_monitor->getReference());
+                }
+                float shift;
+                if (weight_hist && weight_hist->getShift(shift)) checkpoint.writeValue("weight_hist_shift", shift);
+                if (!checkpoint.finish()) return 1;
+                const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - checkpointstart;
+                checkpointtime += duration.count();
+                printf("Checkpointed %.4fs of simulated time to %s (%.1fMB in %.3fs)\n", (double)(t + 1) / timesteps_per_second,
+                       checkpoint_file.c_str(), (double)checkpoint.getNumBytes() / (1024.0 * 1024.0), duration.count());
+            }
+        }
+        const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - starttime;
+        totaltime = duration.count() - checkpointtime;
+    }
+    if ( fast ){
+      std::ofstream timefile;
+      timefile.open("timefile.dat");
+      timefile << std::setprecision(10) << totaltime;
+      timefile.close();
+
+      std::ofstream eventsfile;
+      eventsfile.open("eventsfile.dat");
+      eventsfile << network.getNumSynapticEvents();
+      eventsfile.close();
+    }
+
+    if (weight_monitor) {
+      if (!weight_monitor->finish()) return 1;
+      printf("Wrote %.1fMB of weight snapshots to %s\n", (double)weight_monitor->getNumBytes() / (1024.0 * 1024.0), weight_file.c_str());
+    }
+
+    // Weights in the layout of GeNN's Weights.bin (float32 [mV], row order)
+    Trace::Scope dump("Weight dump", "output");
+    const std::vector<float> &weights = network.getEEWeights();
+    std::ofstream weightfile("./Weights.bin", std::ios::out | std::ios::binary);
+    weightfile.write((const char*)weights.data(), weights.size() * sizeof(float));
+    weightfile.close();
+
+    // Summary for a quick comparison with Auryn's STDPwdConnection
+    double sum = 0.0, sum_sq = 0.0;
+    for (float w : weights) {
+      sum += w;
+      sum_sq += (double)w * (double)w;
+    }
+    const double mean = sum / (double)weights.size();
+    printf("E->E weights [mV]: mean %.6f, sd %.6f, min %.6f, max %.6f\n",
+           mean, std::sqrt(std::max(0.0, (sum_sq / (double)weights.size()) - (mean * mean))),
+           *std::min_element(weights.begin(), weights.end()), *std::max_element(weights.begin(), weights.end()));
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+// Standard C++ includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Shared benchmark utilities
+#include "../../common/decay_table.h"
+#include "../../common/thread_pool.h"
+
+// Native model
+#include "brunel_network.h"
+
+#include <getopt.h>
+
+using namespace SNNBench;
+
+//------------------------------------------------------------------------
+// Cost and accuracy of looking STDP trace decays up in a DecayTable rather
+// than calling exp. The microbenchmark decays traces over whole numbers of
+// timesteps drawn from the exponential inter-spike intervals of neurons
+// firing at --rate. The drift check then runs the plastic Brunel network
+// with each decay side by side and compares their E->E weights.
+//------------------------------------------------------------------------
+namespace
+{
+struct WeightStats
+{
+    double mean;
+    double sd;
+};
+
+WeightStats getStats(const std::vector<float> &weights)
+{
+    double sum = 0.0, sumSq = 0.0;
+    for(float w : weights) {
+        sum += w;
+        sumSq += (double)w * (double)w;
+    }
+    const double mean = sum / (double)weights.size();
+    return {mean, std::sqrt(std::max(0.0, (sumSq / (double)weights.size()) - (mean * mean)))};
+}
+
+//! Time decays of the traces in elapsed, returning ns per decay
+template<typename F>
+double timeDecays(const std::vector<float> &elapsed, unsigned int repeats, F decay, float &checksum)
+{
+    float trace = 0.0f;
+    const auto start = std::chrono::steady_clock::now();
+    for(unsigned int r = 0; r < repeats; r++) {
+        for(float e : elapsed) {
+            trace = (trace * decay(e)) + 1.0f;
+        }
+    }
+    const std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+    checksum += trace;
+    return duration.count() / ((double)elapsed.size() * repeats);
+}
+}   // Anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    double simtime = 100.0;
+    double report_interval = 10.0;
+    double rate = 10.0;
+    unsigned int num_decays = 1 << 20;
+    unsigned int repeats = 20;
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    std::string output = "stdp_decay_check.tsv";
+    const option long_opts[] = {
+      {"simtime", 1, nullptr, 0},
+      {"report_interval", 1, nullptr, 1},
+      {"rate", 1, nullptr, 2},
+      {"num_decays", 1, nullptr, 3},
+      {"repeats", 1, nullptr, 4},
+      {"num_threads", 1, nullptr, 5},
+      {"output", 1, nullptr, 6},
+      {nullptr, 0, nullptr, 0}
+    };
+    while (true) {
+      const auto opt = getopt_long(argc, argv, "", long_opts, nullptr);
+      if (-1 == opt) break;
+      switch (opt) {
+        case 0: simtime = std::stod(optarg); break;
+        case 1: report_interval = std::stod(optarg); break;
+        case 2: rate = std::stod(optarg); break;
+        case 3: num_decays = std::stoi(optarg); break;
+        case 4: repeats = std::stoi(optarg); break;
+        case 5: num_threads = std::stoi(optarg); break;
+        case 6: output = optarg; break;
+        default:
+          fprintf(stderr, "Usage: %s [--simtime S] [--report_interval S] [--rate HZ] [--num_decays N] [--repeats N]\n"
+                          "       [--num_threads N] [--output FILE]\n", argv[0]);
+          return 1;
+      }
+    }
+
+    // Microbenchmark
+    const DecayTable table(BrunelNetwork::TauPlus, Parameters::timestep);
+    {
+        std::mt19937 rng(1234);
+        std::exponential_distribution<double> isi(rate / 1000.0);
+        std::vector<float> elapsed(num_decays);
+        unsigned int numBeyond = 0;
+        for(float &e : elapsed) {
+            e = (float)(std::ceil(isi(rng) / Parameters::timestep) * Parameters::timestep);
+            numBeyond += ((e / Parameters::timestep) >= (double)DecayTable::DefaultLength);
+        }
+
+        float checksum = 0.0f;
+        const float tauPlus = BrunelNetwork::TauPlus;
+        const double expTime = timeDecays(elapsed, repeats, [tauPlus](float e){ return std::exp(-e / tauPlus); }, checksum);
+        const double tableTime = timeDecays(elapsed, repeats, [&table](float e){ return table.get(e); }, checksum);
+
+        double maxRelError = 0.0;
+        for(unsigned int n = 0; n < DecayTable::DefaultLength; n++) {
+            const float e = (float)n * (float)Parameters::timestep;
+            const float reference = std::exp(-e / tauPlus);
+            maxRelError = std::max(maxRelError, std::fabs((double)table.get(e) - reference) / reference);
+        }
+        printf("%u decays over %g Hz inter-spike intervals (%.2f%% beyond the table), checksum %g\n",
+               num_decays, rate, 100.0 * numBeyond / num_decays, checksum);
+        printf("exp: %.2f ns, table: %.2f ns per decay (%.2fx), max relative difference %.3g\n",
+               expTime, tableTime, expTime / tableTime, maxRelError);
+    }
+
+    // Weight drift of the plastic network
+    printf("Running the plastic network with exp and table decays for %gs on %u threads\n",
+           simtime, std::max(1u, num_threads));
+    ThreadPool pool(num_threads);
+    BrunelNetwork expNetwork(true, 0, pool);
+    BrunelNetwork tableNetwork(true, 0, pool);
+    tableNetwork.setUseDecayTable(true);
+    if(!expNetwork.loadConnectivity("..") || !tableNetwork.loadConnectivity("..")) {
+        return 1;
+    }
+
+    std::ofstream tsv(output);
+    tsv << "time_s\texp_mean\texp_sd\ttable_mean\ttable_sd\tmean_drift\trms_difference\tmax_difference\t"
+           "exp_spikes\ttable_spikes\n";
+    printf("%8s %12s %12s %12s %12s %12s %12s\n", "time [s]", "exp mean", "table mean", "mean drift",
+           "rms diff", "max diff", "spikes");
+
+    const unsigned int stepsPerReport = (unsigned int)std::llround(report_interval * 1000.0 / Parameters::timestep);
+    const unsigned int numSteps = (unsigned int)std::llround(simtime * 1000.0 / Parameters::timestep);
+    unsigned long long expSpikes = 0, tableSpikes = 0;
+    for(unsigned int s = 1; s <= numSteps; s++) {
+        expNetwork.step();
+        tableNetwork.step();
+        expSpikes += expNetwork.getSpikes().size();
+        tableSpikes += tableNetwork.getSpikes().size();
+
+        if((s % stepsPerReport) == 0 || s == numSteps) {
+            const std::vector<float> &expWeights = expNetwork.getEEWeights();
+            const std::vector<float> &tableWeights = tableNetwork.getEEWeights();
+            double sumSqDiff = 0.0, maxDiff = 0.0;
+            for(size_t j = 0; j < expWeights.size(); j++) {
+                const double diff = (double)tableWeights[j] - (double)expWeights[j];
+                sumSqDiff += diff * diff;
+                maxDiff = std::max(maxDiff, std::fabs(diff));
+            }
+            const WeightStats expStats = getStats(expWeights);
+            const WeightStats tableStats = getStats(tableWeights);
+            const double time = (double)s * Parameters::timestep / 1000.0;
+            const double meanDrift = (tableStats.mean - expStats.mean) / expStats.mean;
+            const double rmsDiff = std::sqrt(sumSqDiff / (double)expWeights.size());
+
+            printf("%8.1f %12.6f %12.6f %+11.4f%% %12.3g %12.3g %6llu/%llu\n", time, expStats.mean, tableStats.mean,
+                   meanDrift * 100.0, rmsDiff, maxDiff, expSpikes, tableSpikes);
+            tsv << time << "\t" << expStats.mean << "\t" << expStats.sd << "\t" << tableStats.mean << "\t"
+                << tableStats.sd << "\t" << meanDrift << "\t" << rmsDiff << "\t" << maxDiff << "\t" << expSpikes
+                << "\t" << tableSpikes << "\n";
+        }
+    }
+    printf("Written %s\n", output.c_str());
+    return 0;
+}
@@ -25,6 +25,12 @@
 #include <iomanip>
 #include <vector>
 
+#include "../../common/timestep_grouping.h"
+#include "../../common/trace.h"
+#include "../../common/va_connectivity.h"
+
+using namespace SNNBench;
+
 void connect_from_mat(
     int layer1,
     int layer2,
@@ -32,6 +38,7 @@ void connect_from_mat(
     std::string filename,
     SpikingModel* Model,
     float timestep){
+  Trace::Scope trace("Load connectivity", "loader");
 
   ifstream weightfile;
   string line;
@@ -73,14 +80,50 @@ void connect_from_mat(
   }
 }
 
+void connect_procedural(
+    int layer1,
+    int layer2,
+    conductance_spiking_synapse_parameters_struct* SYN_PARAMS,
+    VAConnectivity::Projection projection,
+    int networkscale,
+    SpikingModel* Model){
+  Trace::Scope trace("Generate connectivity", "loader");
+
+  // Rows are generated in memory; scaled networks never touch the disk
+  std::vector<int> prevec, postvec;
+  std::vector<float> weightvec;
+  std::vector<float> delayvec;
+  const float weight = VAConnectivity::getSpec(projection, networkscale).weight;
+  VAConnectivity::generateRows(projection, networkscale, 42,
+    [&](unsigned int pre, const std::vector<unsigned int> &posts){
+      for (unsigned int post : posts){
+        prevec.push_back(pre);
+        postvec.push_back(post);
+        weightvec.push_back(weight);
+        delayvec.push_back(SYN_PARAMS->delay_range[0]);
+      }
+    });
+  printf("Generated %zu synapses for network scale %d\n", prevec.size(), networkscale);
+
+  SYN_PARAMS->pairwise_connect_presynaptic = prevec;
+  SYN_PARAMS->pairwise_connect_postsynaptic = postvec;
+  SYN_PARAMS->pairwise_connect_weight = weightvec;
+  SYN_PARAMS->pairwise_connect_delay = delayvec;
+  SYN_PARAMS->connectivity_type = CONNECTIVITY_TYPE_PAIRWISE;
+  Model->AddSynapseGroup(layer1, layer2, SYN_PARAMS);
+}
+
 
 int main (int argc, char *argv[]){
   // Getting options:
   float simtime = 20.0;
   bool fast = false;
   bool no_TG = false;
+  bool tune_TG = false;
+  float tune_burst = 0.2f;
   int num_timesteps_delay = 8;
   int networkscale = 1;
+  int trace_every = 0;
 
   const char* const short_opts = "";
   const option long_opts[] = {
@@ -88,7 +131,12 @@ int main (int argc, char *argv[]){
     {"fast", 0, nullptr, 1},
     {"num_timesteps_delay", 1, nullptr, 2},
     {"NOTG", 0, nullptr, 3},
-    {"networkscale", 1, nullptr, 4}
+    {"networkscale", 1, nullptr, 4},
+    {"trace", 0, nullptr, 5},
+    {"trace_every", 1, nullptr, 6},
+    {"tune_TG", 0, nullptr, 7},
+    {"tune_burst", 1, nullptr, 8},
+    {nullptr, 0, nullptr, 0}
   };
   // Check the set of options
   while (true) {
@@ -118,6 +166,23 @@ int main (int argc, char *argv[]){
         printf("Running with Network Scaled by: %s\n", optarg);
         networkscale = std::stoi(optarg);
         break;
+      case 5:
+        printf("Writing a chrome://tracing timeline to trace.json\n");
+        Trace::enable();
+        break;
+      case 6:
+        printf("Tracing every %s simulation steps\n", optarg);
+        trace_every = std::stoi(optarg);
+        Trace::enable();
+        break;
+      case 7:
+        printf("Tuning timestep grouping before the run\n");
+        tune_TG = true;
+        break;
+      case 8:
+        printf("Calibrating timestep grouping with %ss bursts\n", optarg);
+        tune_burst = std::stof(optarg);
+        break;
     }
   };
   
@@ -224,50 +289,54 @@ int main (int argc, char *argv[]){
   //BenchModel->AddSynapseGroup(input_layer_ID, EXCITATORY_NEURONS[0], INPUT_SYN_PARAMS);
   */
 
-  // Adding connections based upon matrices given
-  std::string connFile = "../../ee.wmat";
-  if (networkscale != 1){
-    connFile = "../../auryn/" + std::to_string(networkscale) + ".0.0.wmat";
-  }
-  connect_from_mat(
+  // Adding connections based upon matrices given, or generated for scaled networks
+  if (networkscale == 1){
+    connect_from_mat(
       EXCITATORY_NEURONS[0], EXCITATORY_NEURONS[0],
       EXC_OUT_SYN_PARAMS, 
-      connFile.c_str(),
+      "../../ee.wmat",
       BenchModel,
       timestep);
-
-  connFile = "../../ei.wmat";
-  if (networkscale != 1){
-    connFile = "../../auryn/" + std::to_string(networkscale) + ".1.0.wmat";
-  }
-  connect_from_mat(
-    EXCITATORY_NEURONS[0], INHIBITORY_NEURONS[0],
-    EXC_OUT_SYN_PARAMS, 
-    connFile.c_str(),
-    BenchModel,
-    timestep);
-  
-  connFile = "../../ie.wmat";
-  if (networkscale != 1){
-    connFile = "../../auryn/" + std::to_string(networkscale) + ".2.0.wmat";
-  }
-  connect_from_mat(
-    INHIBITORY_NEURONS[0], EXCITATORY_NEURONS[0],
-    INH_OUT_SYN_PARAMS, 
-    connFile.c_str(),
-    BenchModel,
-    timestep);
-  
-  connFile = "../../ii.wmat";
-  if (networkscale != 1){
-    connFile = "../../auryn/" + std::to_string(networkscale) + ".3.0.wmat";
+    connect_from_mat(
+      EXCITATORY_NEURONS[0], INHIBITORY_NEURONS[0],
+      EXC_OUT_SYN_PARAMS, 
+      "../../ei.wmat",
+      BenchModel,
+      timestep);
+    connect_from_mat(
+      INHIBITORY_NEURONS[0], EXCITATORY_NEURONS[0],
+      INH_OUT_SYN_PARAMS, 
+      "../../ie.wmat",
+      BenchModel,
+      timestep);
+    connect_from_mat(
+      INHIBITORY_NEURONS[0], INHIBITORY_NEURONS[0],
+      INH_OUT_SYN_PARAMS, 
+      "../../ii.wmat",
+      BenchModel,
+      timestep);
+  } else {
+    connect_procedural(
+      EXCITATORY_NEURONS[0], EXCITATORY_NEURONS[0],
+      EXC_OUT_SYN_PARAMS,
+      VAConnectivity::Projection::EE, networkscale,
+      BenchModel);
+    connect_procedural(
+      EXCITATORY_NEURONS[0], INHIBITORY_NEURONS[0],
+      EXC_OUT_SYN_PARAMS,
+      VAConnectivity::Projection::EI, networkscale,
+      BenchModel);
+    connect_procedural(
+      INHIBITORY_NEURONS[0], EXCITATORY_NEURONS[0],
+      INH_OUT_SYN_PARAMS,
+      VAConnectivity::Projection::IE, networkscale,
+      BenchModel);
+    connect_procedural(
+      INHIBITORY_NEURONS[0], INHIBITORY_NEURONS[0],
+      INH_OUT_SYN_PARAMS,
+      VAConnectivity::Projection::II, networkscale,
+      BenchModel);
   }
-  connect_from_mat(
-    INHIBITORY_NEURONS[0], INHIBITORY_NEURONS[0],
-    INH_OUT_SYN_PARAMS, 
-    connFile.c_str(),
-    BenchModel,
-    timestep);
 
 
 
@@ -275,12 +344,21 @@ int main (int argc, char *argv[]){
   /*
     COMPLETE NETWORK SETUP
   */
-  BenchModel->finalise_model();
+  {
+    Trace::Scope finalise("Finalise model");
+    BenchModel->finalise_model();
+  }
   if (no_TG)
     BenchModel->timestep_grouping = 1;
+  else if (tune_TG)
+    TimestepGrouping::tune(BenchModel, tune_burst);
+  printf("Running with timestep grouping: %d\n", BenchModel->timestep_grouping);
 
   clock_t starttime = clock();
-  BenchModel->run(simtime);
+  {
+    Trace::Scope run("Simulation", "simulation");
+    Trace::runModel(BenchModel, simtime, timestep, trace_every);
+  }
   clock_t totaltime = clock() - starttime;
   if ( fast ){
     std::ofstream timefile;
@@ -1,3 +1,4 @@
+import os
 import matplotlib.pyplot as plt
 #plt.style.use('ggplot')
 plt.style.use('seaborn-paper')
@@ -9,6 +10,7 @@ simulators = [
         "Brian2",
         "ANNarchy",
         "NEST",
+        "Native",
         ]
 
 single_timestep_delay_results = []
@@ -17,6 +19,11 @@ singlefoldername = "timestep_1_delay/"
 eight_timestep_delay_results = []
 eightfoldername = "timestep_8_delay/"
 
+# Simulators without results for both delays (e.g. the native engine until
+# it has been benchmarked) are left out of the plot
+simulators = [s for s in simulators
+              if os.path.exists(singlefoldername+s+".dat") and os.path.exists(eightfoldername+s+".dat")]
+
 for s in simulators:
     with open(singlefoldername+s+".dat", 'r') as f:
         time = f.read()
@@ -247,7 +247,7 @@ int main(int ac,char *av[]) {
       errcode = 1;
   clock_t totaltime = clock() - starttime;
 
-  if ( fast ){
+  if ( fast && sys->mpi_rank() == 0 ){
     std::ofstream timefile;
     timefile.open("timefile.dat");
     timefile << std::setprecision(10) << ((float)totaltime / CLOCKS_PER_SEC);
@@ -1,11 +1,22 @@
 # GeNN has a two stage compilation process
 # You must ensure that GeNN has been installed correctly
 
+# The network can be scaled relative to 4000 neurons by passing a scale
+# (e.g. ./compile.sh 8). Scaled connectivity is generated at startup.
+NETWORK_SCALE=${1:-1}
+export CXXFLAGS="$CXXFLAGS -DNETWORK_SCALE=$NETWORK_SCALE"
+
+# The neurons use forward Euler unless built with INTEGRATOR=exact
+# (e.g. INTEGRATOR=exact ./compile.sh), which uses the exact propagator
+if [ "${INTEGRATOR:-euler}" = "exact" ]; then
+  export CXXFLAGS="$CXXFLAGS -DEXACT_INTEGRATION=1"
+fi
+
 # First, allow the code generation;
 genn-buildmodel.sh model.cc 
 
-# Finally compile the example
-make -j8
+# Finally compile the example (forcing a rebuild as the scale or integrator may have changed)
+make -B -j8
 
 # In order to run the model;
 # ./simulator --simtime 100.0 --fast
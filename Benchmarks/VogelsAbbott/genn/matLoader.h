@@ -6,6 +6,9 @@
 
 #include "sparseProjection.h"
 
+#include "../../common/trace.h"
+#include "../../common/va_connectivity.h"
+
 void reset_array(
     float* array,
     unsigned int num_elements)
@@ -23,6 +26,7 @@ void ragged_connectivity_from_mat(
     unsigned int numPre,
     unsigned int maxRows)
 {
+  SNNBench::Trace::Scope trace("Load connectivity", "loader");
 
   ifstream weightfile;
   string line;
@@ -69,3 +73,33 @@ void ragged_connectivity_from_mat(
   }
 
 }
+
+void ragged_connectivity_procedural(
+    SNNBench::VAConnectivity::Projection projection,
+    unsigned int scale,
+    float* g,
+    unsigned int* ind,
+    unsigned int* rowLength,
+    unsigned int maxRows)
+{
+  SNNBench::Trace::Scope trace("Generate connectivity", "loader");
+
+  unsigned int numSyns = 0;
+  unsigned int numTruncated = 0;
+  const float weight = SNNBench::VAConnectivity::getSpec(projection, scale).weight;
+  SNNBench::VAConnectivity::generateRows(projection, scale, 42,
+    [&](unsigned int pre, const std::vector<unsigned int> &posts){
+      // Rows are sized with a generous bound but never overrun the matrix
+      const unsigned int length = std::min((unsigned int)posts.size(), maxRows);
+      numTruncated += posts.size() - length;
+      for (unsigned int s = 0; s < length; s++){
+        ind[pre*maxRows + s] = posts[s];
+        g[pre*maxRows + s] = weight;
+      }
+      rowLength[pre] = length;
+      numSyns += length;
+    });
+  printf("Generated %u synapses for network scale %u\n", numSyns, scale);
+  if (numTruncated > 0)
+    printf("WARNING: %u synapses dropped by the maximum row length of %u\n", numTruncated, maxRows);
+}
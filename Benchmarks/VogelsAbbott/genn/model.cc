@@ -11,6 +11,12 @@
 
 #include "parameters.h"
 
+#if EXACT_INTEGRATION
+typedef BoBRobotics::GeNNModels::LIFExact NeuronModel;
+#else
+typedef BoBRobotics::GeNNModels::LIF NeuronModel;
+#endif
+
 void modelDefinition(NNmodel &model)
 {
     initGeNN();
@@ -28,7 +34,7 @@ void modelDefinition(NNmodel &model)
         Parameters::thresholdVoltage);  // 1 - max
 
     // LIF model parameters
-    BoBRobotics::GeNNModels::LIF::ParamValues lifParams(
+    NeuronModel::ParamValues lifParams(
         200.0e-9,    // 0 - C
         20.0,   // 1 - TauM
         Parameters::restVoltage,  // 2 - Vrest
@@ -38,13 +44,13 @@ void modelDefinition(NNmodel &model)
         5.0);    // 6 - TauRefrac
 
     // LIF initial conditions
-    BoBRobotics::GeNNModels::LIF::VarValues lifInit(
+    NeuronModel::VarValues lifInit(
         Parameters::restVoltage, //initVar<InitVarSnippet::Uniform>(vDist),     // 0 - V
         0.0);   // 1 - RefracTime
 
     // Create IF_curr neuron
-    auto *e = model.addNeuronPopulation<BoBRobotics::GeNNModels::LIF>("E", Parameters::numExcitatory, lifParams, lifInit);
-    auto *i = model.addNeuronPopulation<BoBRobotics::GeNNModels::LIF>("I", Parameters::numInhibitory, lifParams, lifInit);
+    auto *e = model.addNeuronPopulation<NeuronModel>("E", Parameters::numExcitatory, lifParams, lifInit);
+    auto *i = model.addNeuronPopulation<NeuronModel>("I", Parameters::numInhibitory, lifParams, lifInit);
 
 
     WeightUpdateModels::StaticPulse::VarValues excs_ini(
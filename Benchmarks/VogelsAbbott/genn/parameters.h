@@ -3,6 +3,22 @@
 // Standard C includes
 #include <cmath>
 
+// Procedural connectivity used when the network is scaled
+#include "../../common/va_connectivity.h"
+
+// Network size relative to 4000 neurons. Set when building the model with
+// "./compile.sh <scale>"; connectivity is then generated procedurally with
+// the connection probability divided by the scale (constant in-degree)
+#ifndef NETWORK_SCALE
+#define NETWORK_SCALE 1
+#endif
+
+// Neuron integrator, chosen when building the model: LIF's forward Euler by
+// default or, with "INTEGRATOR=exact ./compile.sh", LIFExact's exact propagator
+#ifndef EXACT_INTEGRATION
+#define EXACT_INTEGRATION 0
+#endif
+
 //------------------------------------------------------------------------
 // Parameters
 //------------------------------------------------------------------------
@@ -10,15 +26,19 @@ namespace Parameters
 {
     const double timestep = 0.1;
 
+    const bool exactIntegration = (EXACT_INTEGRATION != 0);
+
+    const unsigned int networkScale = NETWORK_SCALE;
+
     // number of cells
-    const unsigned int numNeurons = 4000;
+    const unsigned int numNeurons = 4000 * networkScale;
 
     const double resetVoltage = -60.0;
     const double restVoltage = -60.0;
     const double thresholdVoltage = -50.0;
 
     // connection probability
-    const double probabilityConnection = 0.02;
+    const double probabilityConnection = 0.02 / (double)networkScale;
 
     // number of excitatory cells:number of inhibitory cells
     const double excitatoryInhibitoryRatio = 4.0;
@@ -26,10 +46,11 @@ namespace Parameters
     const unsigned int numExcitatory = (unsigned int)std::round(((double)numNeurons * excitatoryInhibitoryRatio) / (1.0 + excitatoryInhibitoryRatio));
     const unsigned int numInhibitory = numNeurons - numExcitatory;
 
-    const unsigned int EEMaxRow = 95;
-    const unsigned int EIMaxRow = 31;
-    const unsigned int IIMaxRow = 31;
-    const unsigned int IEMaxRow = 87;
+    // Maximum row lengths of the .wmat files or, for scaled networks, a bound on the generated rows
+    const unsigned int EEMaxRow = (networkScale == 1) ? 95 : SNNBench::VAConnectivity::getMaxRowLength(numExcitatory, probabilityConnection);
+    const unsigned int EIMaxRow = (networkScale == 1) ? 31 : SNNBench::VAConnectivity::getMaxRowLength(numInhibitory, probabilityConnection);
+    const unsigned int IIMaxRow = (networkScale == 1) ? 31 : SNNBench::VAConnectivity::getMaxRowLength(numInhibitory, probabilityConnection);
+    const unsigned int IEMaxRow = (networkScale == 1) ? 87 : SNNBench::VAConnectivity::getMaxRowLength(numExcitatory, probabilityConnection);
 
     const unsigned int synapticDelay = 8; //1;
 
@@ -1,5 +1,6 @@
 // Standard C++ includes
 #include <random>
+#include <string>
 
 // GeNN robotics includes
 //#include "common/timer.h"
@@ -7,6 +8,10 @@
 #include "timer.h"
 #include "spike_csv_recorder.h"
 
+// Shared benchmark utilities
+#include "../../common/rate_watchdog.h"
+#include "../../common/trace.h"
+
 // Model parameters
 #include "parameters.h"
 
@@ -21,16 +26,47 @@
 #include <iomanip>
 
 using namespace BoBRobotics;
+using namespace SNNBench;
+
+#ifndef CPU_ONLY
+//! Copy just the spike count of a delayed population's current step from
+//! the device, which is all the rate watchdog needs when spikes aren't pulled
+unsigned int pullCurrentSpikeCount(const unsigned int *d_glbSpkCnt, unsigned int spkQuePtr)
+{
+    unsigned int count;
+    CHECK_CUDA_ERRORS(cudaMemcpy(&count, d_glbSpkCnt + spkQuePtr, sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    return count;
+}
+#endif
+
+//! CPU time of the calling thread alone, where clock() counts every thread's
+double getThreadCPUSeconds()
+{
+    timespec cpuTime;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+    return (double)cpuTime.tv_sec + ((double)cpuTime.tv_nsec * 1.0E-9);
+}
 
 int main (int argc, char *argv[])
 {
     // Getting options:
     float simtime = 20.0;
     bool fast = false;
+    unsigned int trace_every = 0;
+    bool count_events = false;
+    float min_rate = 0.0f, max_rate = 0.0f;
+    float rate_window = 100.0f;
     const char* const short_opts = "";
     const option long_opts[] = {
       {"simtime", 1, nullptr, 0},
       {"fast", 0, nullptr, 1},
+      {"trace", 0, nullptr, 2},
+      {"trace_every", 1, nullptr, 3},
+      {"integrator", 1, nullptr, 4},
+      {"count_events", 0, nullptr, 5},
+      {"rate_watchdog", 1, nullptr, 6},
+      {"rate_window", 1, nullptr, 7},
+      {nullptr, 0, nullptr, 0}
     };
     // Check the set of options
     while (true) {
@@ -48,36 +84,85 @@ int main (int argc, char *argv[])
           printf("Running in fast mode (no spike collection)\n");
           fast = true;
           break;
+        case 2:
+          printf("Writing a chrome://tracing timeline to trace.json\n");
+          Trace::enable();
+          break;
+        case 3:
+          printf("Tracing every %s simulation steps\n", optarg);
+          trace_every = std::stoi(optarg);
+          Trace::enable();
+          break;
+        case 4:
+          // The integrator is part of the generated code, so can only be checked here
+          if (std::string(optarg) != (Parameters::exactIntegration ? "exact" : "euler")) {
+            fprintf(stderr, "Model was built with %s integration; rebuild with INTEGRATOR=%s ./compile.sh\n",
+                    Parameters::exactIntegration ? "exact" : "euler", optarg);
+            return 1;
+          }
+          break;
+        case 5:
+          printf("Counting synaptic events to eventsfile.dat (outside the timed simulation)\n");
+          count_events = true;
+          break;
+        case 6:
+          if (!RateWatchdog::parseBand(optarg, min_rate, max_rate)) {
+            fprintf(stderr, "Rate watchdog band '%s' is not MIN,MAX in Hz\n", optarg);
+            return 1;
+          }
+          printf("Aborting if E or I rates leave [%g, %g]Hz\n", min_rate, max_rate);
+          break;
+        case 7:
+          printf("Rate watchdog window: %sms\n", optarg);
+          rate_window = std::stof(optarg);
+          break;
         default:
           break;
       }
     };
     {
         Timer<> t("Allocation:");
+        Trace::Scope s("Allocation");
         allocateMem();
     }
     
     {
         Timer<> t("Initialization:");
+        Trace::Scope s("Initialization");
         initialize();
     }
     
     // Loading Synapses
     {
         Timer<> t("Synapse setup:");
-        ragged_connectivity_from_mat("../ee.wmat", gEE, CEE.ind, CEE.rowLength, Parameters::numExcitatory, Parameters::EEMaxRow);
+        Trace::Scope s("Synapse setup");
+        // Scaled networks are generated in memory rather than loaded
+        const bool from_file = (Parameters::networkScale == 1);
+        if (from_file)
+          ragged_connectivity_from_mat("../ee.wmat", gEE, CEE.ind, CEE.rowLength, Parameters::numExcitatory, Parameters::EEMaxRow);
+        else
+          ragged_connectivity_procedural(VAConnectivity::Projection::EE, Parameters::networkScale, gEE, CEE.ind, CEE.rowLength, Parameters::EEMaxRow);
         reset_array(inSynEE, Parameters::numExcitatory);
         pushEEStateToDevice();
 
-        ragged_connectivity_from_mat("../ei.wmat", gEI, CEI.ind, CEI.rowLength, Parameters::numExcitatory, Parameters::EIMaxRow);
+        if (from_file)
+          ragged_connectivity_from_mat("../ei.wmat", gEI, CEI.ind, CEI.rowLength, Parameters::numExcitatory, Parameters::EIMaxRow);
+        else
+          ragged_connectivity_procedural(VAConnectivity::Projection::EI, Parameters::networkScale, gEI, CEI.ind, CEI.rowLength, Parameters::EIMaxRow);
         reset_array(inSynEI, Parameters::numInhibitory);
         pushEIStateToDevice();
 
-        ragged_connectivity_from_mat("../ii.wmat", gII, CII.ind, CII.rowLength, Parameters::numInhibitory, Parameters::IIMaxRow);
+        if (from_file)
+          ragged_connectivity_from_mat("../ii.wmat", gII, CII.ind, CII.rowLength, Parameters::numInhibitory, Parameters::IIMaxRow);
+        else
+          ragged_connectivity_procedural(VAConnectivity::Projection::II, Parameters::networkScale, gII, CII.ind, CII.rowLength, Parameters::IIMaxRow);
         reset_array(inSynII, Parameters::numInhibitory);
         pushIIStateToDevice();
 
-        ragged_connectivity_from_mat("../ie.wmat", gIE, CIE.ind, CIE.rowLength, Parameters::numInhibitory, Parameters::IEMaxRow);
+        if (from_file)
+          ragged_connectivity_from_mat("../ie.wmat", gIE, CIE.ind, CIE.rowLength, Parameters::numInhibitory, Parameters::IEMaxRow);
+        else
+          ragged_connectivity_procedural(VAConnectivity::Projection::IE, Parameters::networkScale, gIE, CIE.ind, CIE.rowLength, Parameters::IEMaxRow);
         reset_array(inSynIE, Parameters::numExcitatory);
         pushIEStateToDevice();
     }
@@ -85,39 +170,96 @@ int main (int argc, char *argv[])
     // Final setup
     {
         Timer<> t("Sparse init:");
+        Trace::Scope s("Sparse init");
         initva_benchmark();
     }
 
     // Open CSV output files
-    GeNNUtils::SpikeCSVRecorderDelay spikes("spikes.csv", 3200, spkQuePtrE, glbSpkCntE, glbSpkE);
+    GeNNUtils::SpikeCSVRecorderDelay spikes("spikes.csv", Parameters::numExcitatory, spkQuePtrE, glbSpkCntE, glbSpkE);
+
+    // Stops runaway or silent runs, even in fast mode
+    const bool watch_rates = (max_rate > 0.0f);
+    RateWatchdog watchdog(min_rate, max_rate, rate_window, Parameters::timestep);
+    watchdog.addPopulation("E", Parameters::numExcitatory);
+    watchdog.addPopulation("I", Parameters::numInhibitory);
 
-    clock_t totaltime;
+    // Process CPU time, less the time spent counting synaptic events
+    double totaltime;
+    double counttime = 0.0;
+    unsigned long long num_events = 0;
     {
         Timer<> t("Simulation:");
+        Trace::Scope s("Simulation", "simulation");
         // Loop through timesteps
         int timesteps_per_second = 10000;
         clock_t starttime = clock();
         for(unsigned int t = 0; t < (int)(simtime*timesteps_per_second); t++)
         {
+            const bool trace_step = Trace::shouldTraceStep(t, trace_every);
+            Trace::Scope step("Step", "simulation", trace_step);
+
             // Simulate
 #ifndef CPU_ONLY
             stepTimeGPU();
 
-            if (!fast) pullECurrentSpikesFromDevice();
+            if (!fast) {
+                Trace::Scope pull("Pull spikes", "recording", trace_step);
+                pullECurrentSpikesFromDevice();
+            }
 #else
             stepTimeCPU();
 #endif
 
-            if (!fast) spikes.record(t);
+            // Count synaptic events from the row lengths of this step's spiking neurons
+            if (count_events) {
+              const double countstart = getThreadCPUSeconds();
+#ifndef CPU_ONLY
+              if (fast) pullECurrentSpikesFromDevice();
+              pullICurrentSpikesFromDevice();
+#endif
+              const unsigned int *spk_e = &glbSpkE[spkQuePtrE * Parameters::numExcitatory];
+              for (unsigned int i = 0; i < glbSpkCntE[spkQuePtrE]; i++)
+                num_events += CEE.rowLength[spk_e[i]] + CEI.rowLength[spk_e[i]];
+              const unsigned int *spk_i = &glbSpkI[spkQuePtrI * Parameters::numInhibitory];
+              for (unsigned int i = 0; i < glbSpkCntI[spkQuePtrI]; i++)
+                num_events += CII.rowLength[spk_i[i]] + CIE.rowLength[spk_i[i]];
+              counttime += getThreadCPUSeconds() - countstart;
+            }
+
+            if (!fast) {
+                Trace::Scope record("Record spikes", "recording", trace_step);
+                spikes.record(t);
+            }
+
+            if (watch_rates) {
+#ifndef CPU_ONLY
+                // Only the excitatory spikes are pulled for recording
+                watchdog.addSpikes(0, fast ? pullCurrentSpikeCount(d_glbSpkCntE, spkQuePtrE) : glbSpkCntE[spkQuePtrE]);
+                watchdog.addSpikes(1, pullCurrentSpikeCount(d_glbSpkCntI, spkQuePtrI));
+#else
+                watchdog.addSpikes(0, glbSpkCntE[spkQuePtrE]);
+                watchdog.addSpikes(1, glbSpkCntI[spkQuePtrI]);
+#endif
+                if (!watchdog.endStep()) {
+                  watchdog.printDiagnostic();
+                  return 2;
+                }
+            }
         }
-        totaltime = clock() - starttime;
+        totaltime = ((double)(clock() - starttime) / CLOCKS_PER_SEC) - counttime;
     }
     if ( fast ){
       std::ofstream timefile;
       timefile.open("timefile.dat");
-      timefile << std::setprecision(10) << ((float)totaltime / CLOCKS_PER_SEC);
+      timefile << std::setprecision(10) << (float)totaltime;
       timefile.close();
     }
+    if ( fast && count_events ){
+      std::ofstream eventsfile;
+      eventsfile.open("eventsfile.dat");
+      eventsfile << num_events;
+      eventsfile.close();
+    }
 
     return 0;
 }
@@ -0,0 +1,12 @@
+# The native engine has no dependencies beyond a C++11 compiler
+make -j8
+
+# In order to run the model on 8 threads (connectivity is loaded from ../*.wmat);
+# ./simulator --simtime 100.0 --fast --num_threads 8
+# ./simulator --simtime 100.0 --fast --integrator exact
+
+# Accuracy of the Euler and exact integrators at coarse timesteps against a fine reference;
+# ./integrator_accuracy --simtime 10 --timesteps 0.1,0.25,0.5,1.0
+
+# Sweep 4 offset currents x 4 inhibitory weight scales as one 16 instance ensemble sharing the connectivity;
+# ./ensemble --simtime 10 --ioffset 18,19,20,21 --inh_scale 0.5,1,1.5,2
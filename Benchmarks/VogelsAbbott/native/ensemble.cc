@@ -0,0 +1,180 @@
+// Standard C++ includes
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// GeNN robotics includes
+#include "../genn/timer.h"
+
+// Shared benchmark utilities
+#include "../../common/thread_pool.h"
+#include "../../common/trace.h"
+
+// Native model
+#include "va_ensemble.h"
+#include "va_network.h"
+
+#include <getopt.h>
+
+using namespace BoBRobotics;
+using namespace SNNBench;
+
+//------------------------------------------------------------------------
+// Parameter sweeps of the Vogels-Abbott network as one VAEnsemble: every
+// combination of the --ioffset, --exc_scale and --inh_scale values is an
+// instance, all sharing a single copy of the connectivity. Writes each
+// instance's excitatory and inhibitory firing rates to ensemble.tsv
+//------------------------------------------------------------------------
+namespace
+{
+std::vector<float> parseList(const std::string &list)
+{
+    std::vector<float> values;
+    std::stringstream ss(list);
+    std::string item;
+    while(std::getline(ss, item, ',')) {
+        if(!item.empty()) {
+            values.push_back(std::stof(item));
+        }
+    }
+    return values;
+}
+}   // Anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    float simtime = 10.0;
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    LIFKernels::Integrator integrator = LIFKernels::Integrator::Euler;
+    unsigned int num_timesteps_delay = Parameters::synapticDelay;
+    unsigned int max_timesteps_delay = 0;
+    unsigned int networkscale = 1;
+    std::vector<float> ioffsets{VANetwork::Ioffset};
+    std::vector<float> exc_scales{1.0f};
+    std::vector<float> inh_scales{1.0f};
+    int record_instance = -1;
+    std::string output = "ensemble.tsv";
+    const option long_opts[] = {
+      {"simtime", 1, nullptr, 0},
+      {"num_threads", 1, nullptr, 1},
+      {"networkscale", 1, nullptr, 2},
+      {"num_timesteps_delay", 1, nullptr, 3},
+      {"max_timesteps_delay", 1, nullptr, 4},
+      {"integrator", 1, nullptr, 5},
+      {"ioffset", 1, nullptr, 6},
+      {"exc_scale", 1, nullptr, 7},
+      {"inh_scale", 1, nullptr, 8},
+      {"record_instance", 1, nullptr, 9},
+      {"output", 1, nullptr, 10},
+      {nullptr, 0, nullptr, 0}
+    };
+    while (true) {
+      const auto opt = getopt_long(argc, argv, "", long_opts, nullptr);
+      if (-1 == opt) break;
+      switch (opt) {
+        case 0: simtime = std::stof(optarg); break;
+        case 1: num_threads = std::stoi(optarg); break;
+        case 2: networkscale = std::stoi(optarg); break;
+        case 3: num_timesteps_delay = std::stoi(optarg); break;
+        case 4: max_timesteps_delay = std::stoi(optarg); break;
+        case 5:
+          if (!LIFKernels::selectIntegrator(optarg, integrator)) {
+            fprintf(stderr, "Unknown integrator '%s' (expected euler or exact)\n", optarg);
+            return 1;
+          }
+          break;
+        case 6: ioffsets = parseList(optarg); break;
+        case 7: exc_scales = parseList(optarg); break;
+        case 8: inh_scales = parseList(optarg); break;
+        case 9: record_instance = std::stoi(optarg); break;
+        case 10: output = optarg; break;
+        default:
+          fprintf(stderr, "Usage: %s [--simtime S] [--num_threads N] [--networkscale N] [--num_timesteps_delay D]\n"
+                          "       [--max_timesteps_delay D] [--integrator euler|exact] [--ioffset A,B,...]\n"
+                          "       [--exc_scale A,B,...] [--inh_scale A,B,...] [--record_instance I] [--output FILE]\n",
+                  argv[0]);
+          return 1;
+      }
+    }
+
+    std::vector<VAEnsemble::Instance> instances;
+    for (float ioffset : ioffsets) {
+      for (float exc_scale : exc_scales) {
+        for (float inh_scale : inh_scales) {
+          instances.push_back({ioffset, exc_scale, inh_scale});
+        }
+      }
+    }
+    if (instances.empty() || instances.size() > VAEnsemble::MaxInstances) {
+      fprintf(stderr, "%zu instances requested: an ensemble holds between 1 and %u\n", instances.size(),
+              VAEnsemble::MaxInstances);
+      return 1;
+    }
+    if (record_instance >= (int)instances.size()) {
+      fprintf(stderr, "Cannot record instance %d of %zu\n", record_instance, instances.size());
+      return 1;
+    }
+    printf("Running %zu instances on %u threads\n", instances.size(), std::max(1u, num_threads));
+
+    ThreadPool pool(num_threads);
+    VANetwork network(networkscale, num_timesteps_delay, max_timesteps_delay, pool, integrator);
+    {
+        Timer<> t("Synapse setup:");
+        Trace::Scope s("Synapse setup");
+        if (!network.loadConnectivity("..")) return 1;
+    }
+    VAEnsemble ensemble(network, instances, pool);
+
+    // Record one instance's excitatory spikes as the simulator does
+    std::ofstream spikes;
+    uint64_t record_mask = 0;
+    if (record_instance >= 0) {
+      spikes.open("spikes.csv");
+      spikes.precision(16);
+      spikes << "Time [ms], Neuron ID" << std::endl;
+      record_mask = (uint64_t)1 << record_instance;
+    }
+
+    double totaltime;
+    const unsigned int num_steps = (unsigned int)(simtime * 10000);
+    {
+        Timer<> t("Simulation:");
+        Trace::Scope s("Simulation", "simulation");
+        const auto starttime = std::chrono::steady_clock::now();
+        for (unsigned int t = 0; t < num_steps; t++) {
+            ensemble.step();
+            if (record_mask != 0) {
+                for (unsigned int id : ensemble.getSpikes()) {
+                  if (id >= ensemble.getNumExcitatory()) break;
+                  if (ensemble.getSpikeMask(id) & record_mask) {
+                    spikes << t << "," << id << std::endl;
+                  }
+                }
+            }
+        }
+        const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - starttime;
+        totaltime = duration.count();
+    }
+
+    const unsigned long long num_events = ensemble.getNumSynapticEvents();
+    printf("%zu instances x %u steps in %.3fs: %.0f instance-steps/s, %.3g synaptic events/s\n",
+           instances.size(), num_steps, totaltime, (double)instances.size() * num_steps / totaltime,
+           (double)num_events / totaltime);
+    printf("%llu row segment passes served %.2f instances each on average\n", ensemble.getNumPasses(),
+           ensemble.getMeanInstancesPerPass());
+
+    std::ofstream tsv(output);
+    tsv << "instance\tioffset\texc_scale\tinh_scale\texc_rate_hz\tinh_rate_hz\n";
+    const unsigned int num_inhibitory = ensemble.getNumNeurons() - ensemble.getNumExcitatory();
+    for (unsigned int b = 0; b < instances.size(); b++) {
+      const double exc_rate = ensemble.getNumSpikes(b, true) / (simtime * ensemble.getNumExcitatory());
+      const double inh_rate = ensemble.getNumSpikes(b, false) / (simtime * num_inhibitory);
+      tsv << b << "\t" << instances[b].ioffset << "\t" << instances[b].excitatoryScale << "\t"
+          << instances[b].inhibitoryScale << "\t" << exc_rate << "\t" << inh_rate << "\n";
+    }
+    printf("Written %s\n", output.c_str());
+    return 0;
+}
@@ -0,0 +1,258 @@
+// Standard C++ includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Native model
+#include "va_network.h"
+
+#include <getopt.h>
+
+using namespace SNNBench;
+
+//------------------------------------------------------------------------
+// Accuracy of the forward Euler and exact LIF integrators at coarse
+// timesteps. Independent VA neurons (same parameters, ExpCond synapses and
+// weights as the benchmark) are driven by fixed Poisson input spike trains
+// and simulated at a fine reference timestep and at each coarse timestep.
+// Spike times, firing rates and membrane potentials are compared with the
+// reference, which uses the exact integrator.
+//------------------------------------------------------------------------
+namespace
+{
+struct Input
+{
+    std::vector<std::vector<float>> excTimes;
+    std::vector<std::vector<float>> inhTimes;
+};
+
+struct Result
+{
+    std::vector<std::vector<float>> spikeTimes;
+    std::vector<float> sampledV;
+    double simulationTime;
+};
+
+std::vector<float> poissonTrain(double rate, double duration, std::mt19937 &rng)
+{
+    std::exponential_distribution<double> isi(rate / 1000.0);
+    std::vector<float> times;
+    for(double t = isi(rng); t < duration; t += isi(rng)) {
+        times.push_back((float)t);
+    }
+    return times;
+}
+
+//! Simulate with the native engine's scalar kernel, sampling V every sampleInterval ms
+Result simulate(const Input &input, LIFKernels::Integrator integrator, double dt, double duration, double sampleInterval)
+{
+    const unsigned int numNeurons = (unsigned int)input.excTimes.size();
+    LIFKernels::ExpCondParams p;
+    p.membraneStep = LIFKernels::getMembraneStep(integrator, dt, VANetwork::TauM);
+    p.rmembrane = VANetwork::TauM / VANetwork::C;
+    p.vRest = (float)Parameters::restVoltage;
+    p.vReset = (float)Parameters::resetVoltage;
+    p.vThresh = (float)Parameters::thresholdVoltage;
+    p.ioffset = VANetwork::Ioffset;
+    p.tauRefrac = VANetwork::TauRefrac;
+    p.dt = (float)dt;
+    p.erevExc = VANetwork::ErevExc;
+    p.erevInh = VANetwork::ErevInh;
+    p.expDecayExc = (float)std::exp(-dt / VANetwork::TauExc);
+    p.expDecayInh = (float)std::exp(-dt / VANetwork::TauInh);
+
+    std::vector<float> v(numNeurons, p.vRest);
+    std::vector<float> refracTime(numNeurons, 0.0f);
+    std::vector<float> inSynExc(numNeurons, 0.0f);
+    std::vector<float> inSynInh(numNeurons, 0.0f);
+    std::vector<unsigned int> spikes(numNeurons + LIFKernels::VectorSlack);
+    std::vector<size_t> nextExc(numNeurons, 0);
+    std::vector<size_t> nextInh(numNeurons, 0);
+
+    Result result;
+    result.spikeTimes.resize(numNeurons);
+    const unsigned long long numSteps = (unsigned long long)std::llround(duration / dt);
+    const unsigned long long sampleEvery = (unsigned long long)std::llround(sampleInterval / dt);
+
+    const auto start = std::chrono::steady_clock::now();
+    for(unsigned long long s = 0; s < numSteps; s++) {
+        // Deliver the input spikes which fall within this step
+        const float stepEnd = (float)((double)(s + 1) * dt);
+        for(unsigned int i = 0; i < numNeurons; i++) {
+            for(; nextExc[i] < input.excTimes[i].size() && input.excTimes[i][nextExc[i]] < stepEnd; nextExc[i]++) {
+                inSynExc[i] += (float)Parameters::excitatoryWeight;
+            }
+            for(; nextInh[i] < input.inhTimes[i].size() && input.inhTimes[i][nextInh[i]] < stepEnd; nextInh[i]++) {
+                inSynInh[i] += (float)Parameters::inhibitoryWeight;
+            }
+        }
+
+        const unsigned int numSpikes = LIFKernels::updateExpCondScalar(p, v.data(), refracTime.data(), inSynExc.data(),
+                                                                       inSynInh.data(), 0, numNeurons, spikes.data());
+        for(unsigned int k = 0; k < numSpikes; k++) {
+            result.spikeTimes[spikes[k]].push_back(stepEnd);
+        }
+        if(((s + 1) % sampleEvery) == 0) {
+            result.sampledV.insert(result.sampledV.end(), v.begin(), v.end());
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.simulationTime = elapsed.count();
+    return result;
+}
+
+//! Distance from each reference spike to the nearest spike of the test train
+void compareSpikes(const std::vector<float> &reference, const std::vector<float> &test, double coincidence,
+                   double &sumError, size_t &numMatched)
+{
+    size_t j = 0;
+    for(float t : reference) {
+        while((j + 1) < test.size() && std::fabs(test[j + 1] - t) <= std::fabs(test[j] - t)) {
+            j++;
+        }
+        if(!test.empty()) {
+            const double error = std::fabs(test[j] - t);
+            sumError += error;
+            if(error <= coincidence) {
+                numMatched++;
+            }
+        }
+    }
+}
+
+std::vector<double> parseList(const std::string &list)
+{
+    std::vector<double> values;
+    std::stringstream ss(list);
+    std::string item;
+    while(std::getline(ss, item, ',')) {
+        if(!item.empty()) {
+            values.push_back(std::stod(item));
+        }
+    }
+    return values;
+}
+}   // Anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    double duration = 10.0;
+    unsigned int num_neurons = 256;
+    double reference_dt = 0.01;
+    std::string timesteps = "0.1,0.25,0.5,1.0";
+    double exc_rate = 200.0;
+    double inh_rate = 100.0;
+    double coincidence = 2.0;
+    unsigned int seed = 1234;
+    std::string output = "integrator_accuracy.tsv";
+    const option long_opts[] = {
+      {"simtime", 1, nullptr, 0},
+      {"num_neurons", 1, nullptr, 1},
+      {"reference_dt", 1, nullptr, 2},
+      {"timesteps", 1, nullptr, 3},
+      {"exc_rate", 1, nullptr, 4},
+      {"inh_rate", 1, nullptr, 5},
+      {"coincidence", 1, nullptr, 6},
+      {"seed", 1, nullptr, 7},
+      {"output", 1, nullptr, 8},
+      {nullptr, 0, nullptr, 0}
+    };
+    while (true) {
+      const auto opt = getopt_long(argc, argv, "", long_opts, nullptr);
+      if (-1 == opt) break;
+      switch (opt) {
+        case 0: duration = std::stod(optarg); break;
+        case 1: num_neurons = std::stoi(optarg); break;
+        case 2: reference_dt = std::stod(optarg); break;
+        case 3: timesteps = optarg; break;
+        case 4: exc_rate = std::stod(optarg); break;
+        case 5: inh_rate = std::stod(optarg); break;
+        case 6: coincidence = std::stod(optarg); break;
+        case 7: seed = std::stoi(optarg); break;
+        case 8: output = optarg; break;
+        default:
+          fprintf(stderr, "Usage: %s [--simtime S] [--num_neurons N] [--reference_dt MS] [--timesteps MS,MS,...]\n"
+                          "       [--exc_rate HZ] [--inh_rate HZ] [--coincidence MS] [--seed N] [--output FILE]\n", argv[0]);
+          return 1;
+      }
+    }
+
+    // V is compared every millisecond, so every timestep must divide one
+    const double sampleInterval = 1.0;
+    std::vector<double> dts = parseList(timesteps);
+    dts.insert(dts.begin(), reference_dt);
+    for(double dt : dts) {
+        const double stepsPerSample = sampleInterval / dt;
+        if(dt <= 0.0 || std::fabs(stepsPerSample - std::round(stepsPerSample)) > 1e-6) {
+            fprintf(stderr, "Timestep %g ms does not divide %g ms\n", dt, sampleInterval);
+            return 1;
+        }
+    }
+
+    // Input spike trains, independent of the timestep
+    const double durationMs = duration * 1000.0;
+    std::mt19937 rng(seed);
+    Input input;
+    for(unsigned int i = 0; i < num_neurons; i++) {
+        input.excTimes.push_back(poissonTrain(exc_rate, durationMs, rng));
+        input.inhTimes.push_back(poissonTrain(inh_rate, durationMs, rng));
+    }
+
+    printf("%u neurons for %gs, %g Hz excitatory and %g Hz inhibitory input, reference: exact at %g ms\n",
+           num_neurons, duration, exc_rate, inh_rate, reference_dt);
+    const Result reference = simulate(input, LIFKernels::Integrator::Exact, reference_dt, durationMs, sampleInterval);
+    size_t numReferenceSpikes = 0;
+    for(const auto &s : reference.spikeTimes) {
+        numReferenceSpikes += s.size();
+    }
+    const double referenceRate = (double)numReferenceSpikes / (num_neurons * duration);
+
+    std::ofstream tsv(output);
+    tsv << "integrator\tdt_ms\tsteps\trate_hz\trate_error\tspike_time_error_ms\tcoincidence\tv_rms_error_mv\tsimulation_s\n";
+    printf("%-8s %6s %10s %9s %10s %14s %11s %12s %10s\n", "integ", "dt", "steps", "rate[Hz]", "rate err",
+           "|dt spike|[ms]", "coincident", "V rms [mV]", "time [s]");
+    printf("%-8s %6g %10llu %9.3f %10s %14s %11s %12s %10.3f\n", "exact", reference_dt,
+           (unsigned long long)std::llround(durationMs / reference_dt), referenceRate, "-", "-", "-", "-",
+           reference.simulationTime);
+
+    for(double dt : dts) {
+        if(dt == reference_dt) {
+            continue;
+        }
+        for(auto integrator : {LIFKernels::Integrator::Euler, LIFKernels::Integrator::Exact}) {
+            const Result result = simulate(input, integrator, dt, durationMs, sampleInterval);
+
+            size_t numSpikes = 0;
+            size_t numMatched = 0;
+            double sumError = 0.0;
+            for(unsigned int i = 0; i < num_neurons; i++) {
+                numSpikes += result.spikeTimes[i].size();
+                compareSpikes(reference.spikeTimes[i], result.spikeTimes[i], coincidence, sumError, numMatched);
+            }
+            double sumSquaredV = 0.0;
+            for(size_t k = 0; k < result.sampledV.size(); k++) {
+                const double diff = result.sampledV[k] - reference.sampledV[k];
+                sumSquaredV += diff * diff;
+            }
+
+            const double rate = (double)numSpikes / (num_neurons * duration);
+            const double rateError = (rate - referenceRate) / referenceRate;
+            const double spikeError = sumError / (double)std::max<size_t>(1, numReferenceSpikes);
+            const double coincident = (double)numMatched / (double)std::max<size_t>(1, numReferenceSpikes);
+            const double rmsV = std::sqrt(sumSquaredV / (double)std::max<size_t>(1, result.sampledV.size()));
+            const unsigned long long steps = (unsigned long long)std::llround(durationMs / dt);
+
+            printf("%-8s %6g %10llu %9.3f %+9.2f%% %14.3f %10.1f%% %12.3f %10.3f\n", LIFKernels::getName(integrator), dt,
+                   steps, rate, rateError * 100.0, spikeError, coincident * 100.0, rmsV, result.simulationTime);
+            tsv << LIFKernels::getName(integrator) << "\t" << dt << "\t" << steps << "\t" << rate << "\t" << rateError
+                << "\t" << spikeError << "\t" << coincident << "\t" << rmsV << "\t" << result.simulationTime << "\n";
+        }
+    }
+    printf("Written %s\n", output.c_str());
+    return 0;
+}
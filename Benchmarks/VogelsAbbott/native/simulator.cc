@@ -0,0 +1,226 @@
+// Standard C++ includes
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+// GeNN robotics includes
+#include "../genn/timer.h"
+
+// Shared benchmark utilities
+#include "../../common/fork_trials.h"
+#include "../../common/rate_watchdog.h"
+#include "../../common/thread_pool.h"
+#include "../../common/trace.h"
+
+// Native model
+#include "va_network.h"
+
+#include <getopt.h>
+
+using namespace BoBRobotics;
+using namespace SNNBench;
+
+int main (int argc, char *argv[])
+{
+    // Getting options:
+    float simtime = 20.0;
+    bool fast = false;
+    unsigned int trace_every = 0;
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    std::string isa = "auto";
+    LIFKernels::Integrator integrator = LIFKernels::Integrator::Euler;
+    unsigned int num_timesteps_delay = Parameters::synapticDelay;
+    unsigned int max_timesteps_delay = 0;
+    unsigned int networkscale = 1;
+    unsigned int trials = 0;
+    bool shared_connectivity = false;
+    float min_rate = 0.0f, max_rate = 0.0f;
+    float rate_window = 100.0f;
+    const char* const short_opts = "";
+    const option long_opts[] = {
+      {"simtime", 1, nullptr, 0},
+      {"fast", 0, nullptr, 1},
+      {"trace", 0, nullptr, 2},
+      {"trace_every", 1, nullptr, 3},
+      {"num_threads", 1, nullptr, 4},
+      {"num_timesteps_delay", 1, nullptr, 5},
+      {"networkscale", 1, nullptr, 6},
+      {"isa", 1, nullptr, 7},
+      {"integrator", 1, nullptr, 8},
+      {"max_timesteps_delay", 1, nullptr, 9},
+      {"trials", 1, nullptr, 10},
+      {"shared_connectivity", 0, nullptr, 11},
+      {"rate_watchdog", 1, nullptr, 12},
+      {"rate_window", 1, nullptr, 13},
+      {nullptr, 0, nullptr, 0}
+    };
+    // Check the set of options
+    while (true) {
+      const auto opt = getopt_long(argc, argv, short_opts, long_opts, nullptr);
+
+      // If none
+      if (-1 == opt) break;
+
+      switch (opt){
+        case 0:
+          printf("Running with a simulation time of: %ss\n", optarg);
+          simtime = std::stof(optarg);
+          break;
+        case 1:
+          printf("Running in fast mode (no spike collection)\n");
+          fast = true;
+          break;
+        case 2:
+          printf("Writing a chrome://tracing timeline to trace.json\n");
+          Trace::enable();
+          break;
+        case 3:
+          printf("Tracing every %s simulation steps\n", optarg);
+          trace_every = std::stoi(optarg);
+          Trace::enable();
+          break;
+        case 4:
+          num_threads = std::stoi(optarg);
+          break;
+        case 5:
+          // Delay slots as in GeNN's Parameters::synapticDelay (the setting of each timestep_N_delay run)
+          num_timesteps_delay = std::stoi(optarg);
+          break;
+        case 6:
+          printf("Multiplying the Network Size (and dividing connectivity) by; %s\n", optarg);
+          networkscale = std::stoi(optarg);
+          break;
+        case 7:
+          // Neuron update kernel: scalar, avx2, avx512 or auto (the widest this CPU supports)
+          isa = optarg;
+          break;
+        case 8:
+          if (!LIFKernels::selectIntegrator(optarg, integrator)) {
+            fprintf(stderr, "Unknown integrator '%s' (expected euler or exact)\n", optarg);
+            return 1;
+          }
+          break;
+        case 9:
+          // Each synapse's delay is drawn uniformly from [num_timesteps_delay, max_timesteps_delay]
+          max_timesteps_delay = std::stoi(optarg);
+          break;
+        case 10:
+          printf("Running %s forked trials from the loaded network (no spike collection)\n", optarg);
+          trials = std::stoi(optarg);
+          break;
+        case 11:
+          printf("Loading connectivity through shared memory segments\n");
+          shared_connectivity = true;
+          break;
+        case 12:
+          if (!RateWatchdog::parseBand(optarg, min_rate, max_rate)) {
+            fprintf(stderr, "Rate watchdog band '%s' is not MIN,MAX in Hz\n", optarg);
+            return 1;
+          }
+          printf("Aborting if E or I rates leave [%g, %g]Hz\n", min_rate, max_rate);
+          break;
+        case 13:
+          printf("Rate watchdog window: %sms\n", optarg);
+          rate_window = std::stof(optarg);
+          break;
+        default:
+          break;
+      }
+    };
+    printf("Running on %u threads\n", std::max(1u, num_threads));
+
+    ThreadPool pool(num_threads);
+    VANetwork network(networkscale, num_timesteps_delay, max_timesteps_delay, pool, integrator, LIFKernels::select(isa));
+    printf("Neuron update kernel: %s, %s integration\n", LIFKernels::getName(network.getISA()), LIFKernels::getName(integrator));
+    network.setSharedConnectivity(shared_connectivity);
+
+    // Loading Synapses
+    {
+        Timer<> t("Synapse setup:");
+        Trace::Scope s("Synapse setup");
+        if (!network.loadConnectivity("..")) return 1;
+    }
+
+    // Each trial times the simulation in a child forked from the loaded network
+    if (trials > 0) {
+      const std::vector<ForkTrials::Result> results = ForkTrials::run(trials, pool,
+          [&network, simtime](unsigned int)
+          {
+            const auto starttime = std::chrono::steady_clock::now();
+            for (unsigned int t = 0; t < (unsigned int)(simtime*10000); t++) network.step();
+            const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - starttime;
+            return ForkTrials::Result{true, duration.count(), (double)network.getNumSynapticEvents()};
+          });
+      return ForkTrials::report(results, "trialsfile.dat") ? 0 : 1;
+    }
+
+    std::ofstream spikes;
+    if (!fast) {
+      spikes.open("spikes.csv");
+      spikes.precision(16);
+      spikes << "Time [ms], Neuron ID" << std::endl;
+    }
+
+    // Stops runaway or silent runs, even in fast mode
+    const bool watch_rates = (max_rate > 0.0f);
+    RateWatchdog watchdog(min_rate, max_rate, rate_window, Parameters::timestep);
+    watchdog.addPopulation("E", network.getNumExcitatory());
+    watchdog.addPopulation("I", network.getNumNeurons() - network.getNumExcitatory());
+
+    // Wall clock time, as clock() would add up the CPU time of every thread
+    double totaltime;
+    {
+        Timer<> t("Simulation:");
+        Trace::Scope s("Simulation", "simulation");
+        // Loop through timesteps
+        int timesteps_per_second = 10000;
+        const auto starttime = std::chrono::steady_clock::now();
+        for(unsigned int t = 0; t < (unsigned int)(simtime*timesteps_per_second); t++)
+        {
+            const bool trace_step = Trace::shouldTraceStep(t, trace_every);
+            Trace::Scope step("Step", "simulation", trace_step);
+
+            network.step();
+
+            // Record excitatory spikes as the GeNN simulator does
+            if (!fast) {
+                Trace::Scope record("Record spikes", "recording", trace_step);
+                for (unsigned int id : network.getSpikes()) {
+                  if (id >= network.getNumExcitatory()) break;
+                  spikes << t << "," << id << std::endl;
+                }
+            }
+
+            if (watch_rates) {
+                // Spikes are in ascending order of neuron
+                const std::vector<unsigned int> &step_spikes = network.getSpikes();
+                const unsigned int num_exc = (unsigned int)(std::lower_bound(step_spikes.begin(), step_spikes.end(), network.getNumExcitatory())
+                                                            - step_spikes.begin());
+                watchdog.addSpikes(0, num_exc);
+                watchdog.addSpikes(1, (unsigned int)step_spikes.size() - num_exc);
+                if (!watchdog.endStep()) {
+                  watchdog.printDiagnostic();
+                  return 2;
+                }
+            }
+        }
+        const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - starttime;
+        totaltime = duration.count();
+    }
+    if ( fast ){
+      std::ofstream timefile;
+      timefile.open("timefile.dat");
+      timefile << std::setprecision(10) << totaltime;
+      timefile.close();
+
+      std::ofstream eventsfile;
+      eventsfile.open("eventsfile.dat");
+      eventsfile << network.getNumSynapticEvents();
+      eventsfile.close();
+    }
+
+    return 0;
+}
@@ -0,0 +1,465 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Shared benchmark utilities
+#include "../../common/delay_queue.h"
+#include "../../common/lif_kernels.h"
+#include "../../common/thread_pool.h"
+
+// Native model
+#include "va_network.h"
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::VAEnsemble
+//------------------------------------------------------------------------
+//! Up to 64 instances of the Vogels-Abbott network simulated together for
+//! parameter sweeps. The instances share the read-only connectivity of a
+//! loaded VANetwork and differ in their offset current and the scaling of
+//! their excitatory and inhibitory weights. Neuron state is laid out as
+//! [neuron][instance] so each neuron's instances are updated in one loop,
+//! compiled for the same ISAs as LIFKernels and vectorised by the
+//! compiler. A row segment is queued once per step whichever instances
+//! its neuron spiked in, and when it arrives a single pass over
+//! its synapses delivers to every one of those instances, using the bit
+//! mask of instances recorded when the spike was emitted. An instance
+//! with the network's own parameters reproduces a single-threaded
+//! VANetwork using the scalar kernel exactly, as every operation on its
+//! state is the same
+class VAEnsemble
+{
+public:
+    struct Instance
+    {
+        float ioffset;
+        float excitatoryScale;
+        float inhibitoryScale;
+    };
+
+    VAEnsemble(const VANetwork &network, const std::vector<Instance> &instances, ThreadPool &pool)
+    :   m_Connectivity(network.getConnectivity()), m_NumNeurons(network.getNumNeurons()),
+        m_NumExcitatory(network.getNumExcitatory()), m_NumInstances((unsigned int)instances.size()), m_Pool(pool),
+        m_Params(network.getKernelParams()), m_V((size_t)m_NumNeurons * m_NumInstances, (float)Parameters::restVoltage),
+        m_RefracTime((size_t)m_NumNeurons * m_NumInstances, 0.0f), m_InSynExc((size_t)m_NumNeurons * m_NumInstances, 0.0f),
+        m_InSynInh((size_t)m_NumNeurons * m_NumInstances, 0.0f), m_DelayQueue(network.getMaxDelay()),
+        m_SpikeMasks((size_t)m_DelayQueue.getNumBuckets() * m_NumNeurons, 0), m_Slot(0), m_ISA(network.getISA()),
+        m_Threads(pool.getNumThreads())
+    {
+        for(const auto &i : instances) {
+            m_Ioffset.push_back(i.ioffset);
+            m_ExcitatoryScale.push_back(i.excitatoryScale);
+            m_InhibitoryScale.push_back(i.inhibitoryScale);
+        }
+
+        for(auto &t : m_Threads) {
+            t.inSynExc.assign((size_t)m_NumNeurons * m_NumInstances, 0.0f);
+            t.inSynInh.assign((size_t)m_NumNeurons * m_NumInstances, 0.0f);
+            t.weights.resize(m_NumInstances);
+            t.spiked.resize(m_NumInstances);
+            t.numExcitatorySpikes.assign(m_NumInstances, 0);
+            t.numInhibitorySpikes.assign(m_NumInstances, 0);
+            t.hasInput = false;
+            t.numEvents = 0;
+            t.numPasses = 0;
+            t.numServed = 0;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Advance every instance by one timestep
+    void step()
+    {
+        const unsigned int numInstances = m_NumInstances;
+        const unsigned int numBuckets = m_DelayQueue.getNumBuckets();
+
+        // Deliver the row segments arriving this step to the instances
+        // whose presynaptic neuron spiked delay + 1 steps ago
+        const std::vector<unsigned int> &due = m_DelayQueue.getDue();
+        if(!due.empty()) {
+            m_Pool.parallelFor((unsigned int)due.size(),
+                [this, &due, numInstances, numBuckets](unsigned int begin, unsigned int end, unsigned int thread)
+                {
+                    if(begin == end) {
+                        return;
+                    }
+                    ThreadState &state = m_Threads[thread];
+                    state.hasInput = true;
+                    for(unsigned int d = begin; d < end; d++) {
+                        const unsigned int s = due[d];
+                        const unsigned int pre = m_Connectivity.segmentPre[s];
+                        const unsigned int emitted = (m_Slot + numBuckets - m_Connectivity.segmentDelay[s] - 1) % numBuckets;
+                        const uint64_t mask = m_SpikeMasks[((size_t)emitted * m_NumNeurons) + pre];
+                        const bool excitatory = (pre < m_NumExcitatory);
+                        const float *scale = excitatory ? m_ExcitatoryScale.data() : m_InhibitoryScale.data();
+                        float *inSyn = excitatory ? state.inSynExc.data() : state.inSynInh.data();
+                        const unsigned int segmentStart = m_Connectivity.segmentStart[s];
+                        const unsigned int segmentEnd = m_Connectivity.segmentStart[s + 1];
+                        const unsigned int numSpiking = getPopCount(mask);
+
+                        // When most instances spiked, one pass adds weight * scale to
+                        // every instance of each target, with zero for those that didn't
+                        if((numSpiking * 4) > numInstances) {
+                            float *weights = state.weights.data();
+                            for(unsigned int b = 0; b < numInstances; b++) {
+                                weights[b] = ((mask >> b) & 1) ? scale[b] : 0.0f;
+                            }
+                            for(unsigned int j = segmentStart; j < segmentEnd; j++) {
+                                const float g = m_Connectivity.g[j];
+                                float *target = &inSyn[(size_t)m_Connectivity.ind[j] * numInstances];
+                                for(unsigned int b = 0; b < numInstances; b++) {
+                                    target[b] += g * weights[b];
+                                }
+                            }
+                        }
+                        // Otherwise visit the spiking instances' slots alone
+                        else {
+                            for(uint64_t m = mask; m != 0; m &= (m - 1)) {
+                                const unsigned int b = getLowestBit(m);
+                                for(unsigned int j = segmentStart; j < segmentEnd; j++) {
+                                    inSyn[((size_t)m_Connectivity.ind[j] * numInstances) + b] += m_Connectivity.g[j] * scale[b];
+                                }
+                            }
+                        }
+                        state.numEvents += (unsigned long long)(segmentEnd - segmentStart) * numSpiking;
+                        state.numPasses++;
+                        state.numServed += numSpiking;
+                    }
+                });
+        }
+        m_DelayQueue.clearDue();
+
+        // Input is gathered from the threads which delivered any, in
+        // thread order as VANetwork does
+        m_InputExc.clear();
+        m_InputInh.clear();
+        for(auto &t : m_Threads) {
+            if(t.hasInput) {
+                m_InputExc.push_back(t.inSynExc.data());
+                m_InputInh.push_back(t.inSynInh.data());
+            }
+        }
+
+        // Gather input and update every instance of each neuron, recording which spiked
+        uint64_t *masks = &m_SpikeMasks[(size_t)m_Slot * m_NumNeurons];
+        m_Pool.parallelFor(m_NumNeurons,
+            [this, masks](unsigned int begin, unsigned int end, unsigned int thread)
+            {
+                ThreadState &state = m_Threads[thread];
+                state.spikes.clear();
+                updateNeurons(begin, end, masks, state);
+            }, 16);
+
+        // Chunks are in order, so the merged spikes are sorted
+        m_Spikes.clear();
+        for(auto &t : m_Threads) {
+            m_Spikes.insert(m_Spikes.end(), t.spikes.begin(), t.spikes.end());
+            t.hasInput = false;
+        }
+        for(unsigned int pre : m_Spikes) {
+            m_DelayQueue.push(m_Connectivity, pre);
+        }
+        m_DelayQueue.advance();
+        m_Slot = (m_Slot + 1) % numBuckets;
+    }
+
+    unsigned int getNumInstances() const{ return m_NumInstances; }
+    unsigned int getNumNeurons() const{ return m_NumNeurons; }
+    unsigned int getNumExcitatory() const{ return m_NumExcitatory; }
+    LIFKernels::ISA getISA() const{ return m_ISA; }
+
+    //! Neurons which spiked in any instance in the last step, in ascending order
+    const std::vector<unsigned int> &getSpikes() const{ return m_Spikes; }
+
+    //! Instances in which neuron spiked in the last step, as a bit mask
+    uint64_t getSpikeMask(unsigned int neuron) const
+    {
+        const unsigned int numBuckets = m_DelayQueue.getNumBuckets();
+        return m_SpikeMasks[((size_t)((m_Slot + numBuckets - 1) % numBuckets) * m_NumNeurons) + neuron];
+    }
+
+    //! Spikes of instance's excitatory or inhibitory population so far
+    unsigned long long getNumSpikes(unsigned int instance, bool excitatory) const
+    {
+        unsigned long long numSpikes = 0;
+        for(const auto &t : m_Threads) {
+            numSpikes += excitatory ? t.numExcitatorySpikes[instance] : t.numInhibitorySpikes[instance];
+        }
+        return numSpikes;
+    }
+
+    //! Synaptic events delivered so far, summed over instances
+    unsigned long long getNumSynapticEvents() const
+    {
+        unsigned long long numEvents = 0;
+        for(const auto &t : m_Threads) {
+            numEvents += t.numEvents;
+        }
+        return numEvents;
+    }
+
+    //! Row segment passes so far, each serving every instance that spiked
+    unsigned long long getNumPasses() const
+    {
+        unsigned long long numPasses = 0;
+        for(const auto &t : m_Threads) {
+            numPasses += t.numPasses;
+        }
+        return numPasses;
+    }
+
+    //! Mean number of instances each row segment pass delivered to
+    double getMeanInstancesPerPass() const
+    {
+        unsigned long long numServed = 0;
+        for(const auto &t : m_Threads) {
+            numServed += t.numServed;
+        }
+        const unsigned long long numPasses = getNumPasses();
+        return (numPasses == 0) ? 0.0 : (double)numServed / (double)numPasses;
+    }
+
+    //------------------------------------------------------------------------
+    // Static constants
+    //------------------------------------------------------------------------
+    // Instances are tracked in 64-bit spike masks
+    static const unsigned int MaxInstances = 64;
+
+    // Neurons whose input is gathered before they are updated
+    static const unsigned int GatherBlock = 16;
+
+private:
+    //------------------------------------------------------------------------
+    // ThreadState
+    //------------------------------------------------------------------------
+    struct ThreadState
+    {
+        std::vector<float> inSynExc;
+        std::vector<float> inSynInh;
+        std::vector<float> weights;
+        std::vector<uint32_t> spiked;
+        std::vector<unsigned int> spikes;
+        std::vector<unsigned long long> numExcitatorySpikes;
+        std::vector<unsigned long long> numInhibitorySpikes;
+        bool hasInput;
+        unsigned long long numEvents;
+        unsigned long long numPasses;
+        unsigned long long numServed;
+    };
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    static unsigned int getPopCount(uint64_t mask){ return (unsigned int)__builtin_popcountll(mask); }
+    static unsigned int getLowestBit(uint64_t mask){ return (unsigned int)__builtin_ctzll(mask); }
+
+    //! Pointers an update of a range of neurons works on. The per-thread
+    //! input buffers are those of threads which delivered any spikes
+    struct UpdateArgs
+    {
+        const float *ioffset;
+        float *v;
+        float *refracTime;
+        float *inSynExc;
+        float *inSynInh;
+        float *const *inputExc;
+        float *const *inputInh;
+        unsigned int numInputs;
+        uint32_t *spiked;
+        uint64_t *masks;
+        unsigned int numInstances;
+    };
+
+    //! Add the input the threads delivered to neurons [begin, end) and
+    //! clear it ready for the next step
+    __attribute__((always_inline, optimize("no-trapping-math")))
+    static inline void gatherBody(const UpdateArgs &args, unsigned int begin, unsigned int end)
+    {
+        const size_t first = (size_t)begin * args.numInstances;
+        const size_t last = (size_t)end * args.numInstances;
+        float *__restrict inSynExc = args.inSynExc;
+        float *__restrict inSynInh = args.inSynInh;
+        for(unsigned int t = 0; t < args.numInputs; t++) {
+            float *__restrict inputExc = args.inputExc[t];
+            float *__restrict inputInh = args.inputInh[t];
+            for(size_t n = first; n < last; n++) {
+                inSynExc[n] += inputExc[n];
+                inSynInh[n] += inputInh[n];
+                inputExc[n] = 0.0f;
+                inputInh[n] = 0.0f;
+            }
+        }
+    }
+
+    //! LIFKernels::updateExpCondScalar across the numInstances instances of
+    //! one neuron, flagging those which spiked and returning non-zero if
+    //! any did. The branches become selects so the loop vectorises, which
+    //! GCC only does once float comparisons are declared not to trap (this
+    //! changes no results). The arrays are restrict parameters as there
+    //! are too many to check for overlap at run time
+    __attribute__((always_inline, optimize("no-trapping-math")))
+    static inline uint32_t updateInstances(const LIFKernels::ExpCondParams p, unsigned int numInstances,
+                                           const float *__restrict ioffset, float *__restrict v,
+                                           float *__restrict refracTime, float *__restrict inSynExc,
+                                           float *__restrict inSynInh, uint32_t *__restrict spiked)
+    {
+        uint32_t anySpiked = 0;
+        for(unsigned int b = 0; b < numInstances; b++) {
+            const float vi = v[b];
+            const float ri = refracTime[b];
+            const float isyn = (inSynExc[b] * (p.erevExc - vi)) + (inSynInh[b] * (p.erevInh - vi));
+            const float alpha = isyn * p.rmembrane;
+            const float vIntegrated = vi + (p.membraneStep * ((p.vRest - vi) + alpha + ioffset[b]));
+            const float rDecremented = ri - p.dt;
+
+            const bool integrating = (ri <= 0.0f);
+            const float vNew = integrating ? vIntegrated : vi;
+            const float rNew = integrating ? ri : rDecremented;
+            const uint32_t spike = (uint32_t)(rNew <= 0.0f) & (uint32_t)(vNew >= p.vThresh);
+
+            v[b] = spike ? p.vReset : vNew;
+            refracTime[b] = spike ? p.tauRefrac : rNew;
+            inSynExc[b] *= p.expDecayExc;
+            inSynInh[b] *= p.expDecayInh;
+            spiked[b] = spike;
+            anySpiked |= spike;
+        }
+        return anySpiked;
+    }
+
+    //! Update neurons [begin, end), writing each one's mask of spiking
+    //! instances. As functions with differing optimize attributes can't be
+    //! inlined into each other, only raw pointers are used here
+    __attribute__((always_inline, optimize("no-trapping-math")))
+    static inline void updateBody(const LIFKernels::ExpCondParams &params, const UpdateArgs &args,
+                                  unsigned int begin, unsigned int end)
+    {
+        const unsigned int numInstances = args.numInstances;
+        for(unsigned int i = begin; i < end; i++) {
+            const size_t offset = (size_t)i * numInstances;
+
+            // Spikes are rare, so the mask is only assembled when there are some
+            uint64_t mask = 0;
+            if(updateInstances(params, numInstances, args.ioffset, args.v + offset, args.refracTime + offset,
+                               args.inSynExc + offset, args.inSynInh + offset, args.spiked))
+            {
+                for(unsigned int b = 0; b < numInstances; b++) {
+                    mask |= (uint64_t)args.spiked[b] << b;
+                }
+            }
+            args.masks[i] = mask;
+        }
+    }
+
+    //! Gather and update [begin, end) a block of neurons at a time, so each
+    //! block's gathered input is still in cache when it is updated
+    __attribute__((always_inline, optimize("no-trapping-math")))
+    static inline void updateRangeBody(const LIFKernels::ExpCondParams &params, const UpdateArgs &args,
+                                       unsigned int begin, unsigned int end)
+    {
+        for(unsigned int blockBegin = begin; blockBegin < end; blockBegin += GatherBlock) {
+            const unsigned int blockEnd = std::min(end, blockBegin + GatherBlock);
+            gatherBody(args, blockBegin, blockEnd);
+            updateBody(params, args, blockBegin, blockEnd);
+        }
+    }
+
+    __attribute__((optimize("no-trapping-math")))
+    static void updateRange(const LIFKernels::ExpCondParams &params, const UpdateArgs &args, unsigned int begin,
+                            unsigned int end)
+    {
+        updateRangeBody(params, args, begin, end);
+    }
+
+#ifdef SNNBENCH_X86_SIMD
+    __attribute__((target("avx2"), optimize("no-trapping-math")))
+    static void updateRangeAVX2(const LIFKernels::ExpCondParams &params, const UpdateArgs &args, unsigned int begin,
+                                unsigned int end)
+    {
+        updateRangeBody(params, args, begin, end);
+    }
+
+    __attribute__((target("avx512f"), optimize("no-trapping-math")))
+    static void updateRangeAVX512(const LIFKernels::ExpCondParams &params, const UpdateArgs &args, unsigned int begin,
+                                  unsigned int end)
+    {
+        updateRangeBody(params, args, begin, end);
+    }
+#endif
+
+    //! Update neurons [begin, end) with the kernel for m_ISA, then list
+    //! those which spiked in any instance and count each instance's spikes
+    void updateNeurons(unsigned int begin, unsigned int end, uint64_t *masks, ThreadState &state)
+    {
+        const UpdateArgs args{m_Ioffset.data(), m_V.data(), m_RefracTime.data(), m_InSynExc.data(), m_InSynInh.data(),
+                              m_InputExc.data(), m_InputInh.data(), (unsigned int)m_InputExc.size(),
+                              state.spiked.data(), masks, m_NumInstances};
+
+#ifdef SNNBENCH_X86_SIMD
+        if(m_ISA == LIFKernels::ISA::AVX512) {
+            updateRangeAVX512(m_Params, args, begin, end);
+        }
+        else if(m_ISA == LIFKernels::ISA::AVX2) {
+            updateRangeAVX2(m_Params, args, begin, end);
+        }
+        else
+#endif
+        {
+            updateRange(m_Params, args, begin, end);
+        }
+
+        for(unsigned int i = begin; i < end; i++) {
+            if(masks[i] != 0) {
+                std::vector<unsigned long long> &numSpikes = (i < m_NumExcitatory) ? state.numExcitatorySpikes : state.numInhibitorySpikes;
+                for(uint64_t m = masks[i]; m != 0; m &= (m - 1)) {
+                    numSpikes[getLowestBit(m)]++;
+                }
+                state.spikes.push_back(i);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const DelayedMatrix &m_Connectivity;
+    const unsigned int m_NumNeurons;
+    const unsigned int m_NumExcitatory;
+    const unsigned int m_NumInstances;
+    ThreadPool &m_Pool;
+    const LIFKernels::ExpCondParams m_Params;
+
+    // Per-instance parameters
+    std::vector<float> m_Ioffset;
+    std::vector<float> m_ExcitatoryScale;
+    std::vector<float> m_InhibitoryScale;
+
+    // Neuron state, [neuron][instance]
+    std::vector<float> m_V;
+    std::vector<float> m_RefracTime;
+    std::vector<float> m_InSynExc;
+    std::vector<float> m_InSynInh;
+
+    // Segments in flight and, for each of the last maxDelay + 1 steps, the
+    // instances each neuron spiked in
+    DelayQueue m_DelayQueue;
+    std::vector<uint64_t> m_SpikeMasks;
+    unsigned int m_Slot;
+
+    // Input buffers of the threads which delivered spikes this step
+    std::vector<float*> m_InputExc;
+    std::vector<float*> m_InputInh;
+
+    const LIFKernels::ISA m_ISA;
+
+    // Neurons which spiked in any instance in the last step
+    std::vector<unsigned int> m_Spikes;
+
+    std::vector<ThreadState> m_Threads;
+};
+} // SNNBench
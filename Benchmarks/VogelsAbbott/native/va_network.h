@@ -0,0 +1,314 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Shared benchmark utilities
+#include "../../common/delay_queue.h"
+#include "../../common/lif_kernels.h"
+#include "../../common/ragged_matrix.h"
+#include "../../common/shared_connectivity.h"
+#include "../../common/thread_pool.h"
+#include "../../common/trace.h"
+#include "../../common/va_connectivity.h"
+
+// Model parameters shared with the GeNN implementation
+#include "../genn/parameters.h"
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::VANetwork
+//------------------------------------------------------------------------
+//! Native multi-threaded CPU implementation of the GeNN Vogels-Abbott
+//! model in genn/model.cc: BoBRobotics::GeNNModels::LIF neurons driven by
+//! ExpCond synapses with StaticPulse weights. The excitatory and inhibitory
+//! populations are stored back to back (E first) in structure-of-arrays
+//! form and all four projections are merged into one ragged matrix over
+//! these global indices. Each step delivers the spikes emitted
+//! synapticDelay + 1 steps earlier, exactly as GeNN's delay queue does.
+//! Given a larger maxSynapticDelay, each synapse instead gets a delay
+//! drawn uniformly from [synapticDelay, maxSynapticDelay] and the rows are
+//! split into DelayedMatrix segments delivered through a DelayQueue.
+//! Neurons are updated by the LIFKernels version for isa with either the
+//! forward Euler step of LIF or the exact propagator of LIFExact
+class VANetwork
+{
+public:
+    VANetwork(unsigned int scale, unsigned int synapticDelay, unsigned int maxSynapticDelay, ThreadPool &pool,
+              LIFKernels::Integrator integrator = LIFKernels::Integrator::Euler,
+              LIFKernels::ISA isa = LIFKernels::detect())
+    :   m_NumExcitatory(VAConnectivity::getSpec(VAConnectivity::Projection::EE, scale).numPre),
+        m_NumNeurons(m_NumExcitatory + VAConnectivity::getSpec(VAConnectivity::Projection::II, scale).numPre),
+        m_Scale(scale), m_Pool(pool), m_V(m_NumNeurons, (float)Parameters::restVoltage), m_RefracTime(m_NumNeurons, 0.0f),
+        m_InSynExc(m_NumNeurons, 0.0f), m_InSynInh(m_NumNeurons, 0.0f), m_MinDelay(synapticDelay),
+        m_MaxDelay(std::max(synapticDelay, maxSynapticDelay)), m_DelayQueue(m_MaxDelay), m_ISA(isa), m_SharedConnectivity(false),
+        m_Threads(pool.getNumThreads())
+    {
+        const float dt = (float)Parameters::timestep;
+        m_KernelParams.membraneStep = LIFKernels::getMembraneStep(integrator, Parameters::timestep, TauM);
+        m_KernelParams.rmembrane = TauM / C;
+        m_KernelParams.vRest = (float)Parameters::restVoltage;
+        m_KernelParams.vReset = (float)Parameters::resetVoltage;
+        m_KernelParams.vThresh = (float)Parameters::thresholdVoltage;
+        m_KernelParams.ioffset = Ioffset;
+        m_KernelParams.tauRefrac = TauRefrac;
+        m_KernelParams.dt = dt;
+        m_KernelParams.erevExc = ErevExc;
+        m_KernelParams.erevInh = ErevInh;
+        m_KernelParams.expDecayExc = std::exp(-dt / TauExc);
+        m_KernelParams.expDecayInh = std::exp(-dt / TauInh);
+
+        for(auto &t : m_Threads) {
+            t.inSynExc.assign(m_NumNeurons, 0.0f);
+            t.inSynInh.assign(m_NumNeurons, 0.0f);
+            t.spikes.resize(m_NumNeurons + LIFKernels::VectorSlack);
+            t.numSpikes = 0;
+            t.hasInput = false;
+            t.numEvents = 0;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Load the .wmat files in directory for the unscaled network, otherwise
+    //! generate scaled connectivity procedurally. As in the GeNN model, the
+    //! weights of the files are replaced by Parameters::excitatoryWeight
+    //! and Parameters::inhibitoryWeight
+    bool loadConnectivity(const std::string &directory)
+    {
+        Trace::Scope trace("Load connectivity", "loader");
+
+        RaggedMatrix ee, ei, ie, ii;
+        if(m_Scale == 1) {
+            if(!loadWmatFile(directory + "/ee.wmat", ee) || !loadWmatFile(directory + "/ei.wmat", ei)
+               || !loadWmatFile(directory + "/ie.wmat", ie) || !loadWmatFile(directory + "/ii.wmat", ii))
+            {
+                return false;
+            }
+        }
+        else {
+            generate(VAConnectivity::Projection::EE, ee);
+            generate(VAConnectivity::Projection::EI, ei);
+            generate(VAConnectivity::Projection::IE, ie);
+            generate(VAConnectivity::Projection::II, ii);
+        }
+
+        // Each presynaptic row is its projection onto E followed by that onto I
+        RaggedMatrix merged;
+        merged.numPre = m_NumNeurons;
+        merged.numPost = m_NumNeurons;
+        merged.rowStart.assign(1, 0);
+        merged.ind.reserve(ee.getNumSynapses() + ei.getNumSynapses() + ie.getNumSynapses() + ii.getNumSynapses());
+        merged.g.reserve(merged.ind.capacity());
+        for(unsigned int i = 0; i < m_NumExcitatory; i++) {
+            appendRow(merged, ee, i, 0, (float)Parameters::excitatoryWeight);
+            appendRow(merged, ei, i, m_NumExcitatory, (float)Parameters::excitatoryWeight);
+            merged.rowStart.push_back((unsigned int)merged.ind.size());
+        }
+        for(unsigned int i = 0; i < (m_NumNeurons - m_NumExcitatory); i++) {
+            appendRow(merged, ie, i, 0, (float)Parameters::inhibitoryWeight);
+            appendRow(merged, ii, i, m_NumExcitatory, (float)Parameters::inhibitoryWeight);
+            merged.rowStart.push_back((unsigned int)merged.ind.size());
+        }
+        splitByDelay(merged, getUniformDelays(merged, m_MinDelay, m_MaxDelay, 42, DelayStream), m_Connectivity);
+        printf("%zu synapses between %u neurons in %u segments with delays of %u-%u timesteps\n",
+               m_Connectivity.getNumSynapses(), m_NumNeurons, m_Connectivity.getNumSegments(), m_MinDelay, m_MaxDelay);
+        return true;
+    }
+
+    //! Advance the network by one timestep
+    void step()
+    {
+        // Deliver the row segments arriving this step, each thread taking a
+        // share of them and accumulating into its own buffers
+        const std::vector<unsigned int> &due = m_DelayQueue.getDue();
+        if(!due.empty()) {
+            m_Pool.parallelFor((unsigned int)due.size(),
+                [this, &due](unsigned int begin, unsigned int end, unsigned int thread)
+                {
+                    if(begin == end) {
+                        return;
+                    }
+                    ThreadState &state = m_Threads[thread];
+                    state.hasInput = true;
+                    for(unsigned int d = begin; d < end; d++) {
+                        const unsigned int s = due[d];
+                        float *inSyn = (m_Connectivity.segmentPre[s] < m_NumExcitatory) ? state.inSynExc.data() : state.inSynInh.data();
+                        const unsigned int segmentEnd = m_Connectivity.segmentStart[s + 1];
+                        for(unsigned int j = m_Connectivity.segmentStart[s]; j < segmentEnd; j++) {
+                            inSyn[m_Connectivity.ind[j]] += m_Connectivity.g[j];
+                        }
+                        state.numEvents += segmentEnd - m_Connectivity.segmentStart[s];
+                    }
+                });
+        }
+        m_DelayQueue.clearDue();
+
+        // Update neurons in cache line sized chunks so threads never share one
+        m_Pool.parallelFor(m_NumNeurons,
+            [this](unsigned int begin, unsigned int end, unsigned int thread)
+            {
+                gatherInput(begin, end);
+                ThreadState &state = m_Threads[thread];
+                state.numSpikes += LIFKernels::updateExpCond(m_ISA, m_KernelParams, m_V.data(), m_RefracTime.data(),
+                                                             m_InSynExc.data(), m_InSynInh.data(), begin, end,
+                                                             &state.spikes[state.numSpikes]);
+            }, 16);
+
+        // Chunks are in order, so the merged spikes are sorted
+        m_Spikes.clear();
+        for(auto &t : m_Threads) {
+            m_Spikes.insert(m_Spikes.end(), t.spikes.begin(), t.spikes.begin() + t.numSpikes);
+            t.numSpikes = 0;
+            t.hasInput = false;
+        }
+        for(unsigned int pre : m_Spikes) {
+            m_DelayQueue.push(m_Connectivity, pre);
+        }
+        m_DelayQueue.advance();
+    }
+
+    unsigned int getNumNeurons() const{ return m_NumNeurons; }
+    unsigned int getNumExcitatory() const{ return m_NumExcitatory; }
+    unsigned int getMaxDelay() const{ return m_MaxDelay; }
+    LIFKernels::ISA getISA() const{ return m_ISA; }
+    const LIFKernels::ExpCondParams &getKernelParams() const{ return m_KernelParams; }
+
+    //! Load the .wmat files through shared memory segments that concurrent
+    //! benchmark processes can map rather than parse (see SharedConnectivity)
+    void setSharedConnectivity(bool sharedConnectivity){ m_SharedConnectivity = sharedConnectivity; }
+
+    //! Connectivity once loaded, which a VAEnsemble can share
+    const DelayedMatrix &getConnectivity() const{ return m_Connectivity; }
+
+    //! Neurons which spiked in the last step, in ascending order
+    const std::vector<unsigned int> &getSpikes() const{ return m_Spikes; }
+
+    //! Number of synaptic events delivered so far
+    unsigned long long getNumSynapticEvents() const
+    {
+        unsigned long long numEvents = 0;
+        for(const auto &t : m_Threads) {
+            numEvents += t.numEvents;
+        }
+        return numEvents;
+    }
+
+    //------------------------------------------------------------------------
+    // Static constants
+    //------------------------------------------------------------------------
+    // LIF parameters as in genn/model.cc
+    static constexpr float C = 200.0e-9f;
+    static constexpr float TauM = 20.0f;
+    static constexpr float Ioffset = 20.0f;
+    static constexpr float TauRefrac = 5.0f;
+
+    // ExpCond parameters as in genn/model.cc
+    static constexpr float TauExc = 5.0f;
+    static constexpr float TauInh = 10.0f;
+    static constexpr float ErevExc = 0.0f;
+    static constexpr float ErevInh = -80.0f;
+
+    // Philox stream of the synaptic delays
+    static const uint32_t DelayStream = 4;
+
+private:
+    //------------------------------------------------------------------------
+    // ThreadState
+    //------------------------------------------------------------------------
+    struct ThreadState
+    {
+        std::vector<float> inSynExc;
+        std::vector<float> inSynInh;
+        // Spikes of this thread's chunks, sized for the kernels' compress-stores
+        std::vector<unsigned int> spikes;
+        unsigned int numSpikes;
+        bool hasInput;
+        unsigned long long numEvents;
+    };
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    bool loadWmatFile(const std::string &filename, RaggedMatrix &matrix) const
+    {
+        return m_SharedConnectivity ? SharedConnectivity::loadWmat(filename, matrix) : loadWmat(filename, matrix);
+    }
+
+    void generate(VAConnectivity::Projection projection, RaggedMatrix &matrix)
+    {
+        const VAConnectivity::Spec spec = VAConnectivity::getSpec(projection, m_Scale);
+        matrix.numPre = spec.numPre;
+        matrix.numPost = spec.numPost;
+        matrix.rowStart.assign(1, 0);
+        VAConnectivity::generateRows(projection, m_Scale, 42,
+            [&matrix, &spec](unsigned int, const std::vector<unsigned int> &posts)
+            {
+                matrix.ind.insert(matrix.ind.end(), posts.begin(), posts.end());
+                matrix.g.insert(matrix.g.end(), posts.size(), spec.weight);
+                matrix.rowStart.push_back((unsigned int)matrix.ind.size());
+            });
+    }
+
+    static void appendRow(RaggedMatrix &target, const RaggedMatrix &matrix, unsigned int pre, unsigned int postOffset,
+                          float weight)
+    {
+        for(unsigned int j = matrix.rowStart[pre]; j < matrix.rowStart[pre + 1]; j++) {
+            target.ind.push_back(matrix.ind[j] + postOffset);
+            target.g.push_back(weight);
+        }
+    }
+
+    //! Add the input every thread accumulated for neurons [begin, end)
+    //! and clear it ready for the next step
+    void gatherInput(unsigned int begin, unsigned int end)
+    {
+        for(auto &t : m_Threads) {
+            if(!t.hasInput) {
+                continue;
+            }
+            for(unsigned int i = begin; i < end; i++) {
+                m_InSynExc[i] += t.inSynExc[i];
+                m_InSynInh[i] += t.inSynInh[i];
+                t.inSynExc[i] = 0.0f;
+                t.inSynInh[i] = 0.0f;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const unsigned int m_NumExcitatory;
+    const unsigned int m_NumNeurons;
+    const unsigned int m_Scale;
+    ThreadPool &m_Pool;
+
+    // Neuron state
+    std::vector<float> m_V;
+    std::vector<float> m_RefracTime;
+    std::vector<float> m_InSynExc;
+    std::vector<float> m_InSynInh;
+
+    // Connectivity split by delay and the segments in flight
+    const unsigned int m_MinDelay;
+    const unsigned int m_MaxDelay;
+    DelayedMatrix m_Connectivity;
+    DelayQueue m_DelayQueue;
+
+    // Spikes emitted in the last step
+    std::vector<unsigned int> m_Spikes;
+
+    const LIFKernels::ISA m_ISA;
+    LIFKernels::ExpCondParams m_KernelParams;
+
+    // Load .wmat files through SharedConnectivity
+    bool m_SharedConnectivity;
+
+    std::vector<ThreadState> m_Threads;
+};
+} // SNNBench
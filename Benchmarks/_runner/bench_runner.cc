@@ -0,0 +1,273 @@
+// Benchmark Runner
+// Launches each built benchmark target for a number of warmup and timed
+// repetitions, optionally pinned to a set of CPUs, and summarises the
+// timings each target writes to timefile.dat (median, IQR and a bootstrap
+// confidence interval of the median) in a single results table.
+// With --sweep name=v1,v2,... every target is run at every value of {name}
+// (e.g. the network scale), rebuilding it first if it has a prepare step.
+// With --fork_trials, targets with a trials: line run all their repetitions
+// in one process, each forked from the network after it has been loaded.
+
+#include "config.h"
+#include "process.h"
+#include "stats.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+// Options
+//------------------------------------------------------------------------
+struct Options
+{
+    std::string root;
+    std::vector<int> cpus;
+    int warmup;
+    int repeats;
+    double confidence;
+    bool verbose;
+    bool forkTrials;
+};
+
+//! Run every repetition of a target with a trials: line in one process,
+//! each forked from the network once it has been loaded, and read each
+//! trial's time and events back from trialsfile.dat. The process's wall
+//! time is shared equally between its trials
+bool run_forked(
+    const Config::Target &target,
+    const std::string &config,
+    const std::string &directory,
+    const std::string &command,
+    const Config::Variables &variables,
+    const Options &options,
+    std::ofstream &samples,
+    std::vector<double> &sim_times,
+    std::vector<double> &wall_times,
+    std::vector<double> &event_rates,
+    long &max_rss)
+{
+  const int num_trials = options.warmup + options.repeats;
+  Config::Variables trial_variables = variables;
+  trial_variables["trials"] = std::to_string(num_trials);
+  const std::string trials_command = command + " " + Config::substitute(target.trials, trial_variables);
+  const std::string trialsfile = directory + "/trialsfile.dat";
+  printf("  forking trials: %s\n", trials_command.c_str());
+
+  std::remove(trialsfile.c_str());
+  const Process::Result result = Process::run(directory, trials_command, options.cpus, !options.verbose);
+  if (!result.succeeded()) {
+    printf("  trials failed with status %d\n", result.exitStatus);
+    return false;
+  }
+
+  std::ifstream stream(trialsfile);
+  double sim_time, num_events;
+  const double wall_time = result.wallSeconds / num_trials;
+  for (int r = -options.warmup; r < options.repeats && (stream >> sim_time >> num_events); r++) {
+    // Warmup trials are discarded
+    if (r < 0) continue;
+
+    sim_times.push_back(sim_time);
+    wall_times.push_back(wall_time);
+    event_rates.push_back(num_events / sim_time);
+    samples << target.benchmark << "\t" << target.simulator << "\t" << config << "\t" << r << "\t"
+        << std::setprecision(10) << sim_time << "\t" << wall_time << "\t" << result.maxRSSKB << "\t" << num_events << std::endl;
+    printf("  trial %d: %.4fs\n", r, sim_time);
+  }
+  max_rss = result.maxRSSKB;
+  printf("  %.1fMB, %.4fs wall time per trial\n", (double)result.maxRSSKB / 1024.0, wall_time);
+  return (int)sim_times.size() == options.repeats;
+}
+
+//! Time one target at one point of the sweep, appending to the results
+//! and samples tables. Returns false if any run failed
+bool run_target(
+    const Config::Target &target,
+    const std::string &config,
+    const Config::Variables &variables,
+    const Options &options,
+    std::ofstream &results,
+    std::ofstream &samples)
+{
+  const std::string directory = options.root + "/" + Config::substitute(target.directory, variables);
+  const std::string command = Config::substitute(target.command, variables);
+  const std::string timefile = directory + "/timefile.dat";
+  const std::string eventsfile = directory + "/eventsfile.dat";
+  printf("%s/%s/%s: %s (in %s)\n", target.benchmark.c_str(), target.simulator.c_str(), config.c_str(),
+         command.c_str(), directory.c_str());
+
+  if (!target.prepare.empty()) {
+    const std::string prepare = Config::substitute(target.prepare, variables);
+    printf("  preparing: %s\n", prepare.c_str());
+    const Process::Result result = Process::run(directory, prepare, {}, !options.verbose);
+    if (!result.succeeded()) {
+      printf("  prepare failed with status %d\n", result.exitStatus);
+      return false;
+    }
+  }
+
+  std::vector<double> sim_times, wall_times, event_rates;
+  long max_rss = 0;
+  const bool forked = options.forkTrials && !target.trials.empty();
+  if (forked && !run_forked(target, config, directory, command, variables, options, samples,
+                            sim_times, wall_times, event_rates, max_rss)) return false;
+  for (int r = -options.warmup; !forked && r < options.repeats; r++) {
+    std::remove(timefile.c_str());
+    std::remove(eventsfile.c_str());
+    const Process::Result result = Process::run(directory, command, options.cpus, !options.verbose);
+    if (!result.succeeded()) {
+      printf("  %s %d failed with status %d\n", (r < 0) ? "warmup" : "run", r, result.exitStatus);
+      return false;
+    }
+
+    // Warmup runs are discarded
+    if (r < 0) continue;
+
+    // Prefer the timed-loop duration the benchmark reports itself
+    double sim_time;
+    if (!Process::readNumber(timefile, sim_time)) sim_time = result.wallSeconds;
+
+    // Only some targets can count their synaptic events cheaply
+    double num_events = NAN;
+    if (Process::readNumber(eventsfile, num_events)) event_rates.push_back(num_events / sim_time);
+
+    sim_times.push_back(sim_time);
+    wall_times.push_back(result.wallSeconds);
+    max_rss = std::max(max_rss, result.maxRSSKB);
+    samples << target.benchmark << "\t" << target.simulator << "\t" << config << "\t" << r << "\t"
+        << std::setprecision(10) << sim_time << "\t" << result.wallSeconds << "\t" << result.maxRSSKB << "\t" << num_events << std::endl;
+    printf("  run %d: %.4fs, %.1fMB\n", r, sim_time, (double)result.maxRSSKB / 1024.0);
+  }
+
+  if (sim_times.empty()) return false;
+
+  const Stats::Summary summary = Stats::summarise(sim_times, options.confidence);
+  printf("  median %.4fs, IQR %.4fs, %.0f%% CI [%.4f, %.4f]\n",
+         summary.median, summary.iqr(), options.confidence * 100.0, summary.ciLow, summary.ciHigh);
+  results << target.benchmark << "\t" << target.simulator << "\t" << config << "\t" << summary.n << "\t"
+      << std::setprecision(10) << summary.median << "\t" << summary.q1 << "\t" << summary.q3 << "\t" << summary.iqr() << "\t"
+      << summary.ciLow << "\t" << summary.ciHigh << "\t" << summary.mean << "\t" << summary.min << "\t" << summary.max << "\t"
+      << Stats::median(wall_times) << "\t" << (double)max_rss / 1024.0 << "\t"
+      << (event_rates.empty() ? NAN : Stats::median(event_rates)) << std::endl;
+  return true;
+}
+
+int main (int argc, char *argv[])
+{
+    // Getting options:
+    std::string config_file = "targets.cfg";
+    std::string only = "";
+    std::string output_file = "results.tsv";
+    std::string samples_file = "samples.tsv";
+    std::string sweep_name = "";
+    std::vector<std::string> sweep_values;
+    Config::Variables variables = {{"simtime", "10"}};
+    Options options = {"..", {}, 1, 10, 0.95, false, false};
+    const char* const short_opts = "";
+    const option long_opts[] = {
+      {"config", 1, nullptr, 0},
+      {"root", 1, nullptr, 1},
+      {"warmup", 1, nullptr, 2},
+      {"repeats", 1, nullptr, 3},
+      {"cpus", 1, nullptr, 4},
+      {"set", 1, nullptr, 5},
+      {"only", 1, nullptr, 6},
+      {"output", 1, nullptr, 7},
+      {"samples", 1, nullptr, 8},
+      {"confidence", 1, nullptr, 9},
+      {"verbose", 0, nullptr, 10},
+      {"sweep", 1, nullptr, 11},
+      {"fork_trials", 0, nullptr, 12},
+      {nullptr, 0, nullptr, 0}
+    };
+    // Check the set of options
+    while (true) {
+      const auto opt = getopt_long(argc, argv, short_opts, long_opts, nullptr);
+
+      // If none
+      if (-1 == opt) break;
+
+      switch (opt){
+        case 0:
+          config_file = optarg;
+          break;
+        case 1:
+          options.root = optarg;
+          break;
+        case 2:
+          options.warmup = std::stoi(optarg);
+          break;
+        case 3:
+          options.repeats = std::stoi(optarg);
+          break;
+        case 4:
+          printf("Pinning benchmarks to CPUs: %s\n", optarg);
+          options.cpus = Process::parseCPUList(optarg);
+          break;
+        case 5:
+          if (!Config::parseDefinition(optarg, variables)) return 1;
+          break;
+        case 6:
+          only = optarg;
+          break;
+        case 7:
+          output_file = optarg;
+          break;
+        case 8:
+          samples_file = optarg;
+          break;
+        case 9:
+          options.confidence = std::stod(optarg);
+          break;
+        case 10:
+          options.verbose = true;
+          break;
+        case 11:
+          if (!Config::parseSweep(optarg, sweep_name, sweep_values)) return 1;
+          break;
+        case 12:
+          printf("Forking the repetitions of targets with a trials: line from one loaded network\n");
+          options.forkTrials = true;
+          break;
+        default:
+          return 1;
+      }
+    };
+
+    const std::vector<Config::Target> targets = Config::loadTargets(config_file);
+    if (targets.empty()) {
+      std::cerr << "No benchmark targets found in " << config_file << std::endl;
+      return 1;
+    }
+
+    std::ofstream results(output_file);
+    results << "benchmark\tsimulator\tconfig\tn\tmedian_s\tq1_s\tq3_s\tiqr_s\tci_low_s\tci_high_s\tmean_s\tmin_s\tmax_s\twall_median_s\tmax_rss_mb\tevents_per_s" << std::endl;
+    std::ofstream samples(samples_file);
+    samples << "benchmark\tsimulator\tconfig\trepeat\tsim_s\twall_s\tmax_rss_kb\tevents" << std::endl;
+
+    int failures = 0;
+    for (const auto &target : targets) {
+      if (!only.empty() && target.getKey().find(only) == std::string::npos) continue;
+
+      if (sweep_values.empty()) {
+        if (!run_target(target, target.config, variables, options, results, samples)) failures++;
+        continue;
+      }
+
+      // Each sweep point is recorded as its own configuration e.g. "scaling@scale=4"
+      for (const auto &value : sweep_values) {
+        Config::Variables point_variables = variables;
+        point_variables[sweep_name] = value;
+        const std::string config = target.config + "@" + sweep_name + "=" + value;
+        if (!run_target(target, config, point_variables, options, results, samples)) failures++;
+      }
+    }
+
+    return (failures > 0) ? 1 : 0;
+}
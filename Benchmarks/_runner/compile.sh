@@ -0,0 +1,18 @@
+# Run make to compile the benchmark tools
+make -j8
+
+# In order to time every target in targets.cfg (5 timed runs after 1 warmup, pinned to CPU 2);
+# ./bench_runner --warmup 1 --repeats 5 --cpus 2 --set simtime=10
+
+# In order to time every Vogels-Abbott target at increasing network sizes;
+# ./bench_runner --config scaling.cfg --sweep scale=1,2,4,8,16,32,64 --output scaling.tsv
+
+# In order to measure strong and weak MPI scaling of the Auryn benchmarks on 1 to 8 ranks;
+# ./mpi_scaling --ranks 1,2,4,8 --mode both --repeats 5
+
+# In order to record this machine's baseline and later check fresh timings against it;
+# ./perf_gate --samples samples.tsv --update
+# ./perf_gate --samples samples.tsv
+
+# In order to time the native targets from one loaded network per target, forking a child per repetition;
+# ./bench_runner --only Native --warmup 1 --repeats 20 --fork_trials
@@ -0,0 +1,135 @@
+#pragma once
+
+// Standard C++ includes
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+// Config
+//------------------------------------------------------------------------
+//! Reading the list of benchmark targets and expanding their commands
+namespace Config
+{
+//------------------------------------------------------------------------
+// Config::Target
+//------------------------------------------------------------------------
+//! One benchmark executable with the options for one configuration
+struct Target
+{
+    std::string benchmark;
+    std::string simulator;
+    std::string config;
+    std::string directory;
+    std::string command;
+    std::string prepare;    // optional, run once before each sweep point
+    std::string trials;     // optional, options to run {trials} forked trials in one process
+
+    std::string getKey() const{ return benchmark + "/" + simulator + "/" + config; }
+};
+
+typedef std::map<std::string, std::string> Variables;
+
+//! Load whitespace separated target lines of the form
+//! "benchmark simulator config directory command...". '#' starts a comment
+//! and a following "prepare: command..." line gives the target a command
+//! (e.g. a rebuild) to run once before timing each sweep point. A
+//! "trials: options..." line gives the options which make the target run
+//! {trials} timing trials forked from one loaded network
+inline std::vector<Target> loadTargets(const std::string &filename)
+{
+    std::vector<Target> targets;
+    std::ifstream stream(filename);
+    if(!stream.is_open()) {
+        std::cerr << "Could not open target list: " << filename << std::endl;
+        return targets;
+    }
+
+    std::string line;
+    while(std::getline(stream, line)) {
+        const size_t comment = line.find('#');
+        if(comment != std::string::npos) {
+            line = line.substr(0, comment);
+        }
+
+        std::stringstream ss(line);
+        std::string first;
+        if(!(ss >> first)) {
+            continue;
+        }
+        if(first == "prepare:") {
+            if(targets.empty()) {
+                std::cerr << "prepare: line before any target in " << filename << std::endl;
+                continue;
+            }
+            std::getline(ss >> std::ws, targets.back().prepare);
+            continue;
+        }
+        if(first == "trials:") {
+            if(targets.empty()) {
+                std::cerr << "trials: line before any target in " << filename << std::endl;
+                continue;
+            }
+            std::getline(ss >> std::ws, targets.back().trials);
+            continue;
+        }
+
+        Target target;
+        target.benchmark = first;
+        if(!(ss >> target.simulator >> target.config >> target.directory)) {
+            continue;
+        }
+        std::getline(ss >> std::ws, target.command);
+        if(!target.command.empty()) {
+            targets.push_back(target);
+        }
+    }
+    return targets;
+}
+
+//! Replace every {name} in text with its value from variables
+inline std::string substitute(std::string text, const Variables &variables)
+{
+    for(const auto &v : variables) {
+        const std::string token = "{" + v.first + "}";
+        for(size_t pos = text.find(token); pos != std::string::npos; pos = text.find(token, pos + v.second.size())) {
+            text.replace(pos, token.size(), v.second);
+        }
+    }
+    return text;
+}
+
+//! Parse a "name=v1,v2,..." sweep definition
+inline bool parseSweep(const std::string &definition, std::string &name, std::vector<std::string> &values)
+{
+    const size_t equals = definition.find('=');
+    if(equals == std::string::npos || equals == 0) {
+        std::cerr << "Expected name=v1,v2,..., got: " << definition << std::endl;
+        return false;
+    }
+    name = definition.substr(0, equals);
+    std::stringstream ss(definition.substr(equals + 1));
+    std::string value;
+    while(std::getline(ss, value, ',')) {
+        if(!value.empty()) {
+            values.push_back(value);
+        }
+    }
+    return !values.empty();
+}
+
+//! Parse a "name=value" command line definition into variables
+inline bool parseDefinition(const std::string &definition, Variables &variables)
+{
+    const size_t equals = definition.find('=');
+    if(equals == std::string::npos || equals == 0) {
+        std::cerr << "Expected name=value, got: " << definition << std::endl;
+        return false;
+    }
+    variables[definition.substr(0, equals)] = definition.substr(equals + 1);
+    return true;
+}
+} // Config
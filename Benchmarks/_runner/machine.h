@@ -0,0 +1,77 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX includes
+#include <dirent.h>
+
+//------------------------------------------------------------------------
+// Machine
+//------------------------------------------------------------------------
+//! Identifying the machine timings were taken on, so results are only ever
+//! compared against baselines from the same hardware
+namespace Machine
+{
+//! Value of the first "key : value" line starting with key in filename
+inline std::string readField(const std::string &filename, const std::string &key)
+{
+    std::ifstream stream(filename);
+    std::string line;
+    while(std::getline(stream, line)) {
+        if(line.compare(0, key.size(), key) == 0) {
+            const size_t colon = line.find(':');
+            if(colon != std::string::npos) {
+                const size_t start = line.find_first_not_of(" \t", colon + 1);
+                return (start == std::string::npos) ? "" : line.substr(start);
+            }
+        }
+    }
+    return "";
+}
+
+//! Human readable description of the CPU, core count and any NVIDIA GPUs.
+//! Compiler and library versions are deliberately not included as they
+//! are exactly what a regression check should catch
+inline std::string getDescription()
+{
+    std::ostringstream description;
+    description << "cpu: " << readField("/proc/cpuinfo", "model name") << std::endl;
+    description << "logical_cpus: " << std::thread::hardware_concurrency() << std::endl;
+
+    // One information file per GPU, listed in a stable order
+    DIR *gpus = opendir("/proc/driver/nvidia/gpus");
+    if(gpus != nullptr) {
+        std::vector<std::string> names;
+        while(const dirent *entry = readdir(gpus)) {
+            if(entry->d_name[0] != '.') {
+                names.push_back(entry->d_name);
+            }
+        }
+        closedir(gpus);
+        std::sort(names.begin(), names.end());
+        for(const auto &n : names) {
+            description << "gpu: " << readField("/proc/driver/nvidia/gpus/" + n + "/information", "Model") << std::endl;
+        }
+    }
+    return description.str();
+}
+
+//! Short hexadecimal hash (FNV-1a) of the description, used as a directory name
+inline std::string getFingerprint(const std::string &description)
+{
+    unsigned long long hash = 0xCBF29CE484222325ull;
+    for(char c : description) {
+        hash = (hash ^ (unsigned char)c) * 0x100000001B3ull;
+    }
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", hash);
+    return buffer;
+}
+} // Machine
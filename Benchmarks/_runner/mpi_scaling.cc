@@ -0,0 +1,233 @@
+// MPI Scaling Harness
+// Runs the Auryn benchmarks under "mpirun -np k" on a single host for a
+// list of rank counts, either at a fixed network size (strong scaling) or
+// with --networkscale growing with k (weak scaling). For each point it
+// reports the median elapsed time, speedup, parallel efficiency and the
+// fraction of the run rank 0 did not spend computing (Auryn's elapsed wall
+// time versus the CPU time of its timed loop), and names the knee point
+// after which adding ranks stops paying off.
+
+#include "config.h"
+#include "process.h"
+#include "stats.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+// Point
+//------------------------------------------------------------------------
+//! Timings of one benchmark at one rank count
+struct Point
+{
+    int ranks;
+    int scale;
+    Stats::Summary elapsed;
+    double compute;
+    double commFraction;
+};
+
+//! Time target at one rank count, returning false if any run failed
+bool run_point(
+    const Config::Target &target,
+    int ranks,
+    int scale,
+    Config::Variables variables,
+    const std::string &root,
+    int warmup,
+    int repeats,
+    bool verbose,
+    Point &point)
+{
+  variables["ranks"] = std::to_string(ranks);
+  variables["scale"] = std::to_string(scale);
+  const std::string directory = root + "/" + Config::substitute(target.directory, variables);
+  const std::string command = Config::substitute(target.command, variables);
+  const std::string timefile = directory + "/timefile.dat";
+  const std::string elapsedfile = directory + "/elapsed.dat";
+  printf("%s: %s\n", target.getKey().c_str(), command.c_str());
+
+  std::vector<double> elapsed_times, compute_times, comm_fractions;
+  for (int r = -warmup; r < repeats; r++) {
+    std::remove(timefile.c_str());
+    std::remove(elapsedfile.c_str());
+
+    // Rank placement is left to mpirun (e.g. --bind-to core in the command)
+    const Process::Result result = Process::run(directory, command, {}, !verbose);
+    if (!result.succeeded()) {
+      printf("  %s %d failed with status %d\n", (r < 0) ? "warmup" : "run", r, result.exitStatus);
+      return false;
+    }
+    if (r < 0) continue;
+
+    double elapsed, compute;
+    if (!Process::readNumber(elapsedfile, elapsed)) elapsed = result.wallSeconds;
+    if (!Process::readNumber(timefile, compute)) compute = elapsed;
+
+    // Whatever rank 0 did not spend on the CPU was spent waiting on its peers
+    elapsed_times.push_back(elapsed);
+    compute_times.push_back(compute);
+    comm_fractions.push_back(std::max(0.0, 1.0 - (compute / elapsed)));
+    printf("  run %d: %.4fs elapsed, %.4fs compute\n", r, elapsed, compute);
+  }
+
+  point.ranks = ranks;
+  point.scale = scale;
+  point.elapsed = Stats::summarise(elapsed_times);
+  point.compute = Stats::median(compute_times);
+  point.commFraction = Stats::median(comm_fractions);
+  return true;
+}
+
+int main (int argc, char *argv[])
+{
+    // Getting options:
+    std::string config_file = "mpi_scaling.cfg";
+    std::string root = "..";
+    std::string only = "";
+    std::string output_file = "mpi_scaling.tsv";
+    std::vector<int> rank_counts = {1, 2, 4, 8};
+    Config::Variables variables = {{"simtime", "10"}};
+    bool strong = true;
+    bool weak = true;
+    int warmup = 1;
+    int repeats = 5;
+    double knee_threshold = 0.5;
+    bool verbose = false;
+    const char* const short_opts = "";
+    const option long_opts[] = {
+      {"config", 1, nullptr, 0},
+      {"root", 1, nullptr, 1},
+      {"ranks", 1, nullptr, 2},
+      {"mode", 1, nullptr, 3},
+      {"warmup", 1, nullptr, 4},
+      {"repeats", 1, nullptr, 5},
+      {"set", 1, nullptr, 6},
+      {"only", 1, nullptr, 7},
+      {"output", 1, nullptr, 8},
+      {"knee_threshold", 1, nullptr, 9},
+      {"verbose", 0, nullptr, 10},
+      {nullptr, 0, nullptr, 0}
+    };
+    // Check the set of options
+    while (true) {
+      const auto opt = getopt_long(argc, argv, short_opts, long_opts, nullptr);
+
+      // If none
+      if (-1 == opt) break;
+
+      switch (opt){
+        case 0:
+          config_file = optarg;
+          break;
+        case 1:
+          root = optarg;
+          break;
+        case 2:
+          rank_counts = Process::parseCPUList(optarg);
+          break;
+        case 3:
+          strong = (std::string(optarg) != "weak");
+          weak = (std::string(optarg) != "strong");
+          break;
+        case 4:
+          warmup = std::stoi(optarg);
+          break;
+        case 5:
+          repeats = std::stoi(optarg);
+          break;
+        case 6:
+          if (!Config::parseDefinition(optarg, variables)) return 1;
+          break;
+        case 7:
+          only = optarg;
+          break;
+        case 8:
+          output_file = optarg;
+          break;
+        case 9:
+          knee_threshold = std::stod(optarg);
+          break;
+        case 10:
+          verbose = true;
+          break;
+        default:
+          return 1;
+      }
+    };
+
+    const std::vector<Config::Target> targets = Config::loadTargets(config_file);
+    if (targets.empty() || rank_counts.empty()) {
+      std::cerr << "Nothing to run from " << config_file << std::endl;
+      return 1;
+    }
+    std::sort(rank_counts.begin(), rank_counts.end());
+
+    std::ofstream output(output_file);
+    output << "benchmark\tsimulator\tmode\tranks\tscale\tn\telapsed_median_s\telapsed_q1_s\telapsed_q3_s\tci_low_s\tci_high_s\tcompute_median_s\tcomm_fraction\tspeedup\tefficiency\tmarginal_gain" << std::endl;
+
+    int failures = 0;
+    for (const auto &target : targets) {
+      if (!only.empty() && target.getKey().find(only) == std::string::npos) continue;
+
+      for (const std::string mode : {"strong", "weak"}) {
+        if ((mode == "strong" && !strong) || (mode == "weak" && !weak)) continue;
+
+        std::vector<Point> points;
+        for (int k : rank_counts) {
+          Point point;
+          const int scale = (mode == "weak") ? k : 1;
+          if (run_point(target, k, scale, variables, root, warmup, repeats, verbose, point)) points.push_back(point);
+          else failures++;
+        }
+        if (points.empty()) continue;
+
+        // Throughput is network size per second of elapsed time, so strong and
+        // weak scaling share one definition of speedup and efficiency
+        const Point &base = points.front();
+        const double base_throughput = (double)base.scale / base.elapsed.median;
+        int knee = base.ranks;
+        bool knee_found = false;
+        printf("\n%s %s scaling:\n", target.getKey().c_str(), mode.c_str());
+        printf("  ranks  scale  elapsed [s]   speedup  efficiency  comm  marginal\n");
+        for (size_t p = 0; p < points.size(); p++) {
+          const Point &point = points[p];
+          const double throughput = (double)point.scale / point.elapsed.median;
+          const double speedup = throughput / base_throughput;
+          const double efficiency = speedup * (double)base.ranks / (double)point.ranks;
+
+          // Fraction of the ideal gain realised by the last increase in ranks
+          double marginal = NAN;
+          if (p > 0) {
+            const Point &prev = points[p - 1];
+            const double prev_throughput = (double)prev.scale / prev.elapsed.median;
+            marginal = ((throughput / prev_throughput) - 1.0) / (((double)point.ranks / (double)prev.ranks) - 1.0);
+            if (!knee_found && marginal < knee_threshold) knee_found = true;
+            if (!knee_found) knee = point.ranks;
+          }
+
+          printf("  %5d  %5d  %11.4f  %8.3f  %10.3f  %4.2f  %8.3f\n",
+                 point.ranks, point.scale, point.elapsed.median, speedup, efficiency, point.commFraction, marginal);
+          output << target.benchmark << "\t" << target.simulator << "\t" << mode << "\t" << point.ranks << "\t" << point.scale << "\t"
+              << point.elapsed.n << "\t" << std::setprecision(10) << point.elapsed.median << "\t" << point.elapsed.q1 << "\t"
+              << point.elapsed.q3 << "\t" << point.elapsed.ciLow << "\t" << point.elapsed.ciHigh << "\t" << point.compute << "\t"
+              << point.commFraction << "\t" << speedup << "\t" << efficiency << "\t" << marginal << std::endl;
+        }
+        if (knee_found) {
+          printf("  Knee at %d ranks: further ranks realise less than %.0f%% of their ideal gain\n", knee, knee_threshold * 100.0);
+        } else {
+          printf("  No knee up to %d ranks\n", points.back().ranks);
+        }
+      }
+    }
+
+    return (failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,295 @@
+// Performance Regression Gate
+// Compares fresh benchmark timings against the baseline committed for this
+// machine (baselines/<fingerprint>/samples.tsv) and fails if any
+// simulator/benchmark/config got slower by more than its threshold from
+// thresholds.cfg with a one-sided Mann-Whitney U test agreeing that the
+// slowdown is not noise. Fresh timings are either the samples.tsv written
+// by bench_runner or the <Benchmark>/_results/<config>/<Simulator>.dat
+// layout of the results in this repository (one or more timings per file).
+// With --update the fresh timings become the baseline for this machine.
+
+#include "machine.h"
+#include "stats.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Timings of every benchmark/simulator/config, keyed like Config::Target
+typedef std::map<std::string, std::vector<double>> Samples;
+
+//! Read the sim_s column of a samples.tsv written by bench_runner
+bool load_samples(const std::string &filename, Samples &samples)
+{
+  std::ifstream stream(filename);
+  if (!stream.is_open()) {
+    std::cerr << "Could not open samples: " << filename << std::endl;
+    return false;
+  }
+
+  std::string line;
+  std::getline(stream, line);   // header
+  while (std::getline(stream, line)) {
+    std::stringstream ss(line);
+    std::string benchmark, simulator, config, repeat, sim_s;
+    if (std::getline(ss, benchmark, '\t') && std::getline(ss, simulator, '\t') && std::getline(ss, config, '\t')
+        && std::getline(ss, repeat, '\t') && std::getline(ss, sim_s, '\t')) {
+      samples[benchmark + "/" + simulator + "/" + config].push_back(std::stod(sim_s));
+    }
+  }
+  return true;
+}
+
+//! Read every <root>/<Benchmark>/_results/<config>/<Simulator>.dat. Files
+//! named by a number (core or scale sweeps) are not single configurations
+//! and are skipped; config is the last directory so that Brunel's
+//! simulation_speed/plastic matches the "plastic" target
+void load_dat_dir(const std::string &path, const std::string &benchmark, const std::string &config, Samples &samples)
+{
+  DIR *dir = opendir(path.c_str());
+  if (dir == nullptr) return;
+
+  while (const dirent *entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name[0] == '.') continue;
+
+    const std::string child = path + "/" + name;
+    struct stat info;
+    if (stat(child.c_str(), &info) != 0) continue;
+
+    if (S_ISDIR(info.st_mode)) {
+      load_dat_dir(child, benchmark, name, samples);
+    } else if (!config.empty() && name.size() > 4 && name.substr(name.size() - 4) == ".dat"
+               && !isdigit(name[0])) {
+      std::ifstream stream(child);
+      std::vector<double> &timings = samples[benchmark + "/" + name.substr(0, name.size() - 4) + "/" + config];
+      double t;
+      while (stream >> t) timings.push_back(t);
+    }
+  }
+  closedir(dir);
+}
+
+void load_dat_layout(const std::string &root, Samples &samples)
+{
+  DIR *dir = opendir(root.c_str());
+  if (dir == nullptr) {
+    std::cerr << "Could not open results directory: " << root << std::endl;
+    return;
+  }
+  while (const dirent *entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name[0] != '.' && name[0] != '_') load_dat_dir(root + "/" + name + "/_results", name, "", samples);
+  }
+  closedir(dir);
+}
+
+//------------------------------------------------------------------------
+// Threshold
+//------------------------------------------------------------------------
+//! Largest tolerated slowdown of the benchmark/simulator/config matching
+//! the pattern, where '*' matches anything
+struct Threshold
+{
+    std::string benchmark;
+    std::string simulator;
+    std::string config;
+    double slowdown;
+
+    bool matches(const std::string &key) const
+    {
+      std::stringstream ss(key);
+      std::string parts[3];
+      std::getline(ss, parts[0], '/');
+      std::getline(ss, parts[1], '/');
+      std::getline(ss, parts[2]);
+      return (benchmark == "*" || benchmark == parts[0]) && (simulator == "*" || simulator == parts[1])
+          && (config == "*" || config == parts[2]);
+    }
+};
+
+//! Load "benchmark simulator config slowdown" lines; later lines override
+//! earlier ones so a catch-all default goes first
+std::vector<Threshold> load_thresholds(const std::string &filename)
+{
+  std::vector<Threshold> thresholds;
+  std::ifstream stream(filename);
+  std::string line;
+  while (std::getline(stream, line)) {
+    const size_t comment = line.find('#');
+    if (comment != std::string::npos) line = line.substr(0, comment);
+
+    std::stringstream ss(line);
+    Threshold threshold;
+    if (ss >> threshold.benchmark >> threshold.simulator >> threshold.config >> threshold.slowdown) {
+      thresholds.push_back(threshold);
+    }
+  }
+  return thresholds;
+}
+
+double get_threshold(const std::vector<Threshold> &thresholds, const std::string &key, double fallback)
+{
+  double slowdown = fallback;
+  for (const auto &t : thresholds) {
+    if (t.matches(key)) slowdown = t.slowdown;
+  }
+  return slowdown;
+}
+
+int main (int argc, char *argv[])
+{
+    // Getting options:
+    std::string samples_file = "";
+    std::string dat_root = "";
+    std::string baseline_root = "baselines";
+    std::string thresholds_file = "thresholds.cfg";
+    std::string output_file = "gate.tsv";
+    double default_threshold = 0.1;
+    double alpha = 0.05;
+    bool update = false;
+    const char* const short_opts = "";
+    const option long_opts[] = {
+      {"samples", 1, nullptr, 0},
+      {"dat", 1, nullptr, 1},
+      {"baselines", 1, nullptr, 2},
+      {"thresholds", 1, nullptr, 3},
+      {"threshold", 1, nullptr, 4},
+      {"alpha", 1, nullptr, 5},
+      {"output", 1, nullptr, 6},
+      {"update", 0, nullptr, 7},
+      {nullptr, 0, nullptr, 0}
+    };
+    // Check the set of options
+    while (true) {
+      const auto opt = getopt_long(argc, argv, short_opts, long_opts, nullptr);
+
+      // If none
+      if (-1 == opt) break;
+
+      switch (opt){
+        case 0:
+          samples_file = optarg;
+          break;
+        case 1:
+          dat_root = optarg;
+          break;
+        case 2:
+          baseline_root = optarg;
+          break;
+        case 3:
+          thresholds_file = optarg;
+          break;
+        case 4:
+          default_threshold = std::stod(optarg);
+          break;
+        case 5:
+          alpha = std::stod(optarg);
+          break;
+        case 6:
+          output_file = optarg;
+          break;
+        case 7:
+          update = true;
+          break;
+        default:
+          return 1;
+      }
+    };
+
+    // Load the fresh timings
+    Samples current;
+    if (!dat_root.empty()) {
+      load_dat_layout(dat_root, current);
+    } else {
+      if (!load_samples(samples_file.empty() ? "samples.tsv" : samples_file, current)) return 1;
+    }
+    if (current.empty()) {
+      std::cerr << "No timings found" << std::endl;
+      return 1;
+    }
+
+    const std::string description = Machine::getDescription();
+    const std::string baseline_dir = baseline_root + "/" + Machine::getFingerprint(description);
+    const std::string baseline_file = baseline_dir + "/samples.tsv";
+    printf("Machine %s:\n%s", Machine::getFingerprint(description).c_str(), description.c_str());
+
+    // Store the fresh timings as this machine's baseline
+    if (update) {
+      mkdir(baseline_root.c_str(), 0755);
+      mkdir(baseline_dir.c_str(), 0755);
+      std::ofstream(baseline_dir + "/machine.txt") << description;
+      std::ofstream baseline(baseline_file);
+      baseline << "benchmark\tsimulator\tconfig\trepeat\tsim_s" << std::endl;
+      for (const auto &s : current) {
+        std::string key = s.first;
+        for (char &c : key) if (c == '/') c = '\t';
+        for (size_t r = 0; r < s.second.size(); r++) {
+          baseline << key << "\t" << r << "\t" << std::setprecision(10) << s.second[r] << std::endl;
+        }
+      }
+      printf("Baseline of %zu timings written to %s\n", current.size(), baseline_file.c_str());
+      return 0;
+    }
+
+    Samples baseline;
+    if (!load_samples(baseline_file, baseline)) {
+      std::cerr << "No baseline for this machine: run with --update to record one" << std::endl;
+      return 1;
+    }
+
+    const std::vector<Threshold> thresholds = load_thresholds(thresholds_file);
+    std::ofstream output(output_file);
+    output << "benchmark\tsimulator\tconfig\tbaseline_n\tcurrent_n\tbaseline_median_s\tcurrent_median_s\tslowdown\tthreshold\tp_value\tstatus" << std::endl;
+
+    int regressions = 0;
+    printf("%-45s %10s %10s %9s %9s %8s  %s\n", "target", "base [s]", "now [s]", "slowdown", "threshold", "p", "status");
+    for (const auto &c : current) {
+      const auto b = baseline.find(c.first);
+      if (b == baseline.end() || b->second.empty() || c.second.empty()) {
+        printf("%-45s %10s %10s %9s %9s %8s  %s\n", c.first.c_str(), "-", "-", "-", "-", "-", "no baseline");
+        continue;
+      }
+
+      const double base_median = Stats::median(b->second);
+      const double current_median = Stats::median(c.second);
+      const double slowdown = (current_median / base_median) - 1.0;
+      const double threshold = get_threshold(thresholds, c.first, default_threshold);
+      const double p = Stats::mannWhitneyGreater(c.second, b->second);
+
+      // Both the size and the significance of the slowdown have to be shown.
+      // With too few repeats for the test to ever reach alpha only the
+      // size is checked, and the result is marked as such
+      const bool testable = (Stats::mannWhitneyGreater(std::vector<double>(c.second.size(), 1.0),
+                                                       std::vector<double>(b->second.size(), 0.0)) < alpha);
+      std::string status = "ok";
+      if (slowdown > threshold && (!testable || p < alpha)) {
+        status = testable ? "REGRESSION" : "REGRESSION (untested)";
+        regressions++;
+      } else if (slowdown < -threshold && (!testable || Stats::mannWhitneyGreater(b->second, c.second) < alpha)) {
+        status = "faster";
+      }
+
+      printf("%-45s %10.4f %10.4f %+8.1f%% %8.1f%% %8.4f  %s\n", c.first.c_str(), base_median, current_median,
+             slowdown * 100.0, threshold * 100.0, p, status.c_str());
+      std::string key = c.first;
+      for (char &ch : key) if (ch == '/') ch = '\t';
+      output << key << "\t" << b->second.size() << "\t" << c.second.size() << "\t" << std::setprecision(10)
+          << base_median << "\t" << current_median << "\t" << slowdown << "\t" << threshold << "\t" << p << "\t"
+          << status << std::endl;
+    }
+
+    if (regressions > 0) {
+      printf("%d regression(s) beyond threshold\n", regressions);
+      return 1;
+    }
+    return 0;
+}
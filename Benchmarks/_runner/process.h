@@ -0,0 +1,126 @@
+#pragma once
+
+// Standard C++ includes
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// POSIX includes
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+// Process
+//------------------------------------------------------------------------
+//! Launching benchmark executables and collecting what they report
+namespace Process
+{
+//------------------------------------------------------------------------
+// Process::Result
+//------------------------------------------------------------------------
+struct Result
+{
+    int exitStatus;
+    double wallSeconds;
+    double userSeconds;
+    double systemSeconds;
+    long maxRSSKB;
+
+    bool succeeded() const{ return exitStatus == 0; }
+};
+
+//! Parse a CPU list such as "2", "0,2,4" or "4-7"
+inline std::vector<int> parseCPUList(const std::string &list)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string item;
+    while(std::getline(ss, item, ',')) {
+        if(item.empty()) {
+            continue;
+        }
+        const size_t dash = item.find('-');
+        if(dash == std::string::npos) {
+            cpus.push_back(std::stoi(item));
+        }
+        else {
+            const int first = std::stoi(item.substr(0, dash));
+            const int last = std::stoi(item.substr(dash + 1));
+            for(int c = first; c <= last; c++) {
+                cpus.push_back(c);
+            }
+        }
+    }
+    return cpus;
+}
+
+//! Run command through /bin/sh in directory, optionally pinned to a set of
+//! CPUs, and wait for it, collecting resource usage of the child
+inline Result run(const std::string &directory, const std::string &command, const std::vector<int> &cpus,
+                  bool quiet)
+{
+    // Avoid the child inheriting (and re-printing) buffered output
+    fflush(stdout);
+    fflush(stderr);
+
+    const auto start = std::chrono::steady_clock::now();
+    const pid_t pid = fork();
+    if(pid < 0) {
+        perror("fork");
+        return {-1, 0.0, 0.0, 0.0, 0};
+    }
+    else if(pid == 0) {
+        if(!cpus.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for(int c : cpus) {
+                CPU_SET(c, &set);
+            }
+            if(sched_setaffinity(0, sizeof(set), &set) != 0) {
+                perror("sched_setaffinity");
+                _exit(126);
+            }
+        }
+        if(chdir(directory.c_str()) != 0) {
+            perror(directory.c_str());
+            _exit(126);
+        }
+        if(quiet) {
+            if(freopen("/dev/null", "w", stdout) == nullptr) {
+                _exit(126);
+            }
+        }
+        execl("/bin/sh", "sh", "-c", command.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    if(wait4(pid, &status, 0, &usage) < 0) {
+        perror("wait4");
+        return {-1, 0.0, 0.0, 0.0, 0};
+    }
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+    Result result;
+    result.exitStatus = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    result.wallSeconds = wall.count();
+    result.userSeconds = (double)usage.ru_utime.tv_sec + ((double)usage.ru_utime.tv_usec * 1.0e-6);
+    result.systemSeconds = (double)usage.ru_stime.tv_sec + ((double)usage.ru_stime.tv_usec * 1.0e-6);
+    result.maxRSSKB = usage.ru_maxrss;
+    return result;
+}
+
+//! Read the single number that the benchmarks write to timefile.dat etc.
+inline bool readNumber(const std::string &filename, double &value)
+{
+    std::ifstream stream(filename);
+    return (stream >> value) ? true : false;
+}
+} // Process
@@ -0,0 +1,183 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------
+// Stats
+//------------------------------------------------------------------------
+//! Robust summary statistics for small sets of repeated timings
+namespace Stats
+{
+//! Linearly interpolated quantile (the same definition as numpy's default)
+inline double quantile(std::vector<double> samples, double q)
+{
+    if(samples.empty()) {
+        return NAN;
+    }
+    std::sort(samples.begin(), samples.end());
+    const double pos = q * (double)(samples.size() - 1);
+    const size_t lower = (size_t)std::floor(pos);
+    const size_t upper = std::min(lower + 1, samples.size() - 1);
+    const double frac = pos - (double)lower;
+    return samples[lower] + (frac * (samples[upper] - samples[lower]));
+}
+
+inline double median(const std::vector<double> &samples)
+{
+    return quantile(samples, 0.5);
+}
+
+inline double mean(const std::vector<double> &samples)
+{
+    double sum = 0.0;
+    for(double s : samples) {
+        sum += s;
+    }
+    return samples.empty() ? NAN : sum / (double)samples.size();
+}
+
+//------------------------------------------------------------------------
+// Stats::Summary
+//------------------------------------------------------------------------
+struct Summary
+{
+    size_t n;
+    double median;
+    double q1;
+    double q3;
+    double ciLow;
+    double ciHigh;
+    double mean;
+    double min;
+    double max;
+
+    double iqr() const{ return q3 - q1; }
+};
+
+//! Percentile bootstrap confidence interval of the median. Uses a fixed
+//! seed so the same samples always give the same interval
+inline void bootstrapMedianCI(const std::vector<double> &samples, double confidence, unsigned int numResamples,
+                              double &low, double &high)
+{
+    if(samples.size() < 2) {
+        low = high = median(samples);
+        return;
+    }
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+    std::vector<double> resample(samples.size());
+    std::vector<double> medians;
+    medians.reserve(numResamples);
+    for(unsigned int r = 0; r < numResamples; r++) {
+        for(double &s : resample) {
+            s = samples[pick(rng)];
+        }
+        medians.push_back(median(resample));
+    }
+
+    const double alpha = 1.0 - confidence;
+    low = quantile(medians, 0.5 * alpha);
+    high = quantile(medians, 1.0 - (0.5 * alpha));
+}
+
+inline Summary summarise(const std::vector<double> &samples, double confidence = 0.95,
+                         unsigned int numResamples = 10000)
+{
+    Summary summary;
+    summary.n = samples.size();
+    summary.median = median(samples);
+    summary.q1 = quantile(samples, 0.25);
+    summary.q3 = quantile(samples, 0.75);
+    summary.mean = mean(samples);
+    summary.min = samples.empty() ? NAN : *std::min_element(samples.begin(), samples.end());
+    summary.max = samples.empty() ? NAN : *std::max_element(samples.begin(), samples.end());
+    bootstrapMedianCI(samples, confidence, numResamples, summary.ciLow, summary.ciHigh);
+    return summary;
+}
+
+//! One-sided Mann-Whitney U test of whether samples in a tend to be larger
+//! than those in b, returning the p-value. The exact distribution of U is
+//! used for small tie-free samples and the tie-corrected normal
+//! approximation otherwise
+inline double mannWhitneyGreater(const std::vector<double> &a, const std::vector<double> &b)
+{
+    const size_t m = a.size();
+    const size_t n = b.size();
+    if(m == 0 || n == 0) {
+        return NAN;
+    }
+
+    // Rank the pooled samples, giving ties their average rank
+    std::vector<std::pair<double, bool>> pooled;
+    for(double x : a) {
+        pooled.emplace_back(x, true);
+    }
+    for(double x : b) {
+        pooled.emplace_back(x, false);
+    }
+    std::sort(pooled.begin(), pooled.end());
+    double rankSumA = 0.0;
+    double tieTerm = 0.0;
+    for(size_t i = 0; i < pooled.size();) {
+        size_t j = i;
+        while(j < pooled.size() && pooled[j].first == pooled[i].first) {
+            j++;
+        }
+        const double rank = 0.5 * (double)(i + j + 1);
+        const double t = (double)(j - i);
+        tieTerm += (t * t * t) - t;
+        for(size_t k = i; k < j; k++) {
+            if(pooled[k].second) {
+                rankSumA += rank;
+            }
+        }
+        i = j;
+    }
+    const double u = rankSumA - (0.5 * (double)(m * (m + 1)));
+
+    if(tieTerm == 0.0 && (m * n) <= 400) {
+        // Number of arrangements giving each U, built up one sample at a time
+        const size_t maxU = m * n;
+        std::vector<std::vector<double>> counts(n + 1, std::vector<double>(maxU + 1, 0.0));
+        for(size_t j = 0; j <= n; j++) {
+            counts[j][0] = 1.0;
+        }
+        for(size_t i = 1; i <= m; i++) {
+            std::vector<std::vector<double>> next(n + 1, std::vector<double>(maxU + 1, 0.0));
+            next[0][0] = 1.0;
+            for(size_t j = 1; j <= n; j++) {
+                for(size_t k = 0; k <= maxU; k++) {
+                    next[j][k] = next[j - 1][k] + ((k >= j) ? counts[j][k - j] : 0.0);
+                }
+            }
+            counts.swap(next);
+        }
+        double total = 0.0;
+        double tail = 0.0;
+        for(size_t k = 0; k <= maxU; k++) {
+            total += counts[n][k];
+            if((double)k >= u - 1E-9) {
+                tail += counts[n][k];
+            }
+        }
+        return tail / total;
+    }
+
+    const double N = (double)(m + n);
+    const double meanU = 0.5 * (double)(m * n);
+    const double varU = ((double)(m * n) / 12.0) * ((N + 1.0) - (tieTerm / (N * (N - 1.0))));
+    if(varU <= 0.0) {
+        return 1.0;
+    }
+
+    // Continuity corrected
+    const double z = (u - meanU - 0.5) / std::sqrt(varU);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+} // Stats
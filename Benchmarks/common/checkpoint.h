@@ -0,0 +1,332 @@
+#pragma once
+
+// Standard C++ includes
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Shared benchmark utilities
+#include "trace.h"
+
+//------------------------------------------------------------------------
+// Binary checkpoints of network state. A checkpoint is a header followed
+// by named sections, each an array of plain values padded to 8 bytes and
+// ended by an empty "end" section, so it can be written as a stream
+// without knowing its contents up front:
+//
+//   "SNNBCKPT" | version (uint64)
+//   name (char[24]) | bytes (uint64) | data | padding   (repeated)
+//   "end"      (char[24]) | 0        (uint64)
+//
+// Values are written in the machine's own byte order
+//------------------------------------------------------------------------
+namespace SNNBench {
+namespace Checkpoint {
+//------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------
+static const char Magic[8] = {'S', 'N', 'N', 'B', 'C', 'K', 'P', 'T'};
+static const uint64_t Version = 1;
+static const size_t MaxNameLength = 23;
+
+//------------------------------------------------------------------------
+// Free functions
+//------------------------------------------------------------------------
+//! Append the size and modification time of filename to key, which
+//! identifies a file an image was built from without reading it. Returns
+//! false if it can't be stat'ed
+inline bool appendFileStamp(const std::string &filename, std::vector<uint64_t> &key)
+{
+    struct stat st;
+    if(stat(filename.c_str(), &st) != 0) {
+        perror(filename.c_str());
+        return false;
+    }
+    key.push_back((uint64_t)st.st_size);
+    key.push_back((uint64_t)st.st_mtim.tv_sec);
+    key.push_back((uint64_t)st.st_mtim.tv_nsec);
+    return true;
+}
+
+//! Get the size of filename in bytes, returning false if it can't be stat'ed
+inline bool getFileSize(const std::string &filename, uint64_t &size)
+{
+    struct stat st;
+    if(stat(filename.c_str(), &st) != 0) {
+        perror(filename.c_str());
+        return false;
+    }
+    size = (uint64_t)st.st_size;
+    return true;
+}
+
+//! Cut an output file back to the size it had when a checkpoint was
+//! written, dropping whatever the run wrote after it. Returns false if
+//! the file is missing or shorter than that
+inline bool truncateFile(const std::string &filename, uint64_t size)
+{
+    uint64_t currentSize;
+    if(!getFileSize(filename, currentSize)) {
+        return false;
+    }
+    if(currentSize < size) {
+        fprintf(stderr, "%s is shorter than when it was checkpointed\n", filename.c_str());
+        return false;
+    }
+    if(truncate(filename.c_str(), (off_t)size) != 0) {
+        perror(filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------
+// SNNBench::Checkpoint::Writer
+//------------------------------------------------------------------------
+//! Streams sections to filename.tmp, which finish() renames over filename
+//! once it is complete and synced, so a run killed part way through a
+//! write leaves the previous checkpoint intact
+class Writer
+{
+public:
+    Writer(const std::string &filename)
+    :   m_Filename(filename), m_TempFilename(filename + ".tmp"), m_File(fopen(m_TempFilename.c_str(), "wb")),
+        m_Good(m_File != nullptr), m_NumBytes(0)
+    {
+        if(!m_Good) {
+            perror(m_TempFilename.c_str());
+            return;
+        }
+        put(Magic, sizeof(Magic));
+        put(&Version, sizeof(Version));
+    }
+
+    ~Writer()
+    {
+        if(m_File != nullptr) {
+            fclose(m_File);
+            remove(m_TempFilename.c_str());
+        }
+    }
+
+    Writer(const Writer&) = delete;
+    Writer &operator=(const Writer&) = delete;
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Write count values as section name
+    template<typename T>
+    void write(const std::string &name, const T *data, size_t count)
+    {
+        putSection(name, data, count * sizeof(T));
+    }
+
+    template<typename T>
+    void write(const std::string &name, const std::vector<T> &data)
+    {
+        write(name, data.data(), data.size());
+    }
+
+    //! Write a single value as section name
+    template<typename T>
+    void writeValue(const std::string &name, const T &value)
+    {
+        write(name, &value, 1);
+    }
+
+    //! End the checkpoint and atomically replace any previous one,
+    //! returning false if anything failed to write
+    bool finish()
+    {
+        if(m_File == nullptr) {
+            return false;
+        }
+        putSection("end", nullptr, 0);
+        m_Good = m_Good && (fflush(m_File) == 0) && (fsync(fileno(m_File)) == 0);
+        m_Good = (fclose(m_File) == 0) && m_Good;
+        m_File = nullptr;
+        if(!m_Good || rename(m_TempFilename.c_str(), m_Filename.c_str()) != 0) {
+            perror(m_Filename.c_str());
+            remove(m_TempFilename.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    //! Bytes written so far
+    size_t getNumBytes() const{ return m_NumBytes; }
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    void put(const void *data, size_t bytes)
+    {
+        if(m_Good && bytes > 0) {
+            m_Good = (fwrite(data, 1, bytes, m_File) == bytes);
+            m_NumBytes += bytes;
+        }
+    }
+
+    void putSection(const std::string &name, const void *data, size_t bytes)
+    {
+        char paddedName[MaxNameLength + 1] = {};
+        strncpy(paddedName, name.c_str(), MaxNameLength);
+        const uint64_t size = bytes;
+        put(paddedName, sizeof(paddedName));
+        put(&size, sizeof(size));
+        put(data, bytes);
+
+        static const char zeros[8] = {};
+        put(zeros, (8 - (bytes % 8)) % 8);
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const std::string m_Filename;
+    const std::string m_TempFilename;
+    FILE *m_File;
+    bool m_Good;
+    size_t m_NumBytes;
+};
+
+//------------------------------------------------------------------------
+// SNNBench::Checkpoint::Reader
+//------------------------------------------------------------------------
+//! Maps a checkpoint read-only and indexes its sections, which are then
+//! copied straight out of the mapping
+class Reader
+{
+public:
+    Reader(const std::string &filename)
+    :   m_Data(nullptr), m_Size(0)
+    {
+        Trace::Scope trace("Map checkpoint", "loader");
+
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if(fd < 0) {
+            perror(filename.c_str());
+            return;
+        }
+        struct stat st;
+        if(fstat(fd, &st) == 0 && (size_t)st.st_size >= (sizeof(Magic) + sizeof(Version))) {
+            void *data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED) {
+                m_Data = static_cast<const char*>(data);
+                m_Size = (size_t)st.st_size;
+            }
+        }
+        close(fd);
+
+        if(m_Data == nullptr || memcmp(m_Data, Magic, sizeof(Magic)) != 0
+           || *reinterpret_cast<const uint64_t*>(m_Data + sizeof(Magic)) != Version || !index())
+        {
+            fprintf(stderr, "%s is not a complete version %llu checkpoint\n", filename.c_str(), (unsigned long long)Version);
+            m_Sections.clear();
+        }
+    }
+
+    ~Reader()
+    {
+        if(m_Data != nullptr) {
+            munmap(const_cast<char*>(m_Data), m_Size);
+        }
+    }
+
+    Reader(const Reader&) = delete;
+    Reader &operator=(const Reader&) = delete;
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    bool isValid() const{ return !m_Sections.empty(); }
+
+    bool hasSection(const std::string &name) const{ return m_Sections.find(name) != m_Sections.end(); }
+
+    //! Copy section name into data, which is resized to fit. Returns false
+    //! if there is no such section or its size isn't a whole number of Ts
+    template<typename T>
+    bool read(const std::string &name, std::vector<T> &data) const
+    {
+        const auto s = m_Sections.find(name);
+        if(s == m_Sections.end() || (s->second.bytes % sizeof(T)) != 0) {
+            fprintf(stderr, "Checkpoint has no section '%s' of the expected type\n", name.c_str());
+            return false;
+        }
+        data.resize(s->second.bytes / sizeof(T));
+        memcpy(data.data(), m_Data + s->second.offset, s->second.bytes);
+        return true;
+    }
+
+    //! Copy section name into data, which must be exactly count Ts
+    template<typename T>
+    bool read(const std::string &name, T *data, size_t count) const
+    {
+        const auto s = m_Sections.find(name);
+        if(s == m_Sections.end() || s->second.bytes != (count * sizeof(T))) {
+            fprintf(stderr, "Checkpoint section '%s' is missing or has the wrong size\n", name.c_str());
+            return false;
+        }
+        memcpy(data, m_Data + s->second.offset, s->second.bytes);
+        return true;
+    }
+
+    template<typename T>
+    bool readValue(const std::string &name, T &value) const
+    {
+        return read(name, &value, 1);
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Section
+    //------------------------------------------------------------------------
+    struct Section
+    {
+        size_t offset;
+        size_t bytes;
+    };
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    //! Find every section, returning false unless the end section is reached
+    bool index()
+    {
+        size_t offset = sizeof(Magic) + sizeof(Version);
+        while((offset + MaxNameLength + 1 + sizeof(uint64_t)) <= m_Size) {
+            const std::string name(m_Data + offset, strnlen(m_Data + offset, MaxNameLength + 1));
+            const uint64_t bytes = *reinterpret_cast<const uint64_t*>(m_Data + offset + MaxNameLength + 1);
+            offset += MaxNameLength + 1 + sizeof(uint64_t);
+            if(name == "end") {
+                return true;
+            }
+            if(bytes > (m_Size - offset)) {
+                return false;
+            }
+            m_Sections[name] = {offset, (size_t)bytes};
+            offset += (size_t)((bytes + 7) / 8) * 8;
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const char *m_Data;
+    size_t m_Size;
+    std::map<std::string, Section> m_Sections;
+};
+} // Checkpoint
+} // SNNBench
@@ -0,0 +1,53 @@
+#pragma once
+
+// Standard C++ includes
+#include <cmath>
+#include <vector>
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::DecayTable
+//------------------------------------------------------------------------
+//! exp(-elapsed / tau) for trace decays. Traces are only ever decayed
+//! between spike times, so elapsed is a whole number n of timesteps and
+//! the decay is looked up as entry n, falling back to exp for intervals
+//! longer than the table
+class DecayTable
+{
+public:
+    DecayTable(double tau, double dt, unsigned int length = DefaultLength)
+    :   m_Tau((float)tau), m_StepsPerMs((float)(1.0 / dt)), m_Length((float)length), m_Values(length)
+    {
+        for(unsigned int n = 0; n < length; n++) {
+            m_Values[n] = (float)std::exp(-(double)n * dt / tau);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Decay over elapsed [ms]
+    float get(float elapsed) const
+    {
+        const float steps = (elapsed * m_StepsPerMs) + 0.5f;
+        return (steps < m_Length) ? m_Values[(unsigned int)steps] : std::exp(-elapsed / m_Tau);
+    }
+
+    const std::vector<float> &getValues() const{ return m_Values; }
+
+    //------------------------------------------------------------------------
+    // Static constants
+    //------------------------------------------------------------------------
+    // 409.6 ms at 0.1 ms timesteps: 16 KB, by when a 20 ms trace has decayed to 1e-9
+    static const unsigned int DefaultLength = 4096;
+
+private:
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const float m_Tau;
+    const float m_StepsPerMs;
+    const float m_Length;
+    std::vector<float> m_Values;
+};
+} // SNNBench
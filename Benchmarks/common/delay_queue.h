@@ -0,0 +1,188 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <vector>
+
+// Shared benchmark utilities
+#include "philox.h"
+#include "ragged_matrix.h"
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::DelayedMatrix
+//------------------------------------------------------------------------
+//! Connectivity split by delay at load time. The synapses of each row are
+//! grouped into segments sharing a delay (in timesteps, with GeNN's
+//! meaning: a spike reaches its targets delay + 1 steps after it is
+//! emitted). Segment s of row pre is ind/g[segmentStart[s], segmentStart[s + 1])
+//! for s in [rowSegments[pre], rowSegments[pre + 1]). With a uniform delay
+//! every row is one segment, laid out exactly as its RaggedMatrix row
+struct DelayedMatrix
+{
+    unsigned int numPre;
+    unsigned int numPost;
+    std::vector<unsigned int> rowSegments;
+    std::vector<unsigned int> segmentStart;
+    std::vector<unsigned int> segmentDelay;
+    std::vector<unsigned int> segmentPre;
+    std::vector<unsigned int> ind;
+    std::vector<float> g;
+
+    unsigned int getNumSegments() const{ return (unsigned int)segmentDelay.size(); }
+    unsigned int getSegmentLength(unsigned int s) const{ return segmentStart[s + 1] - segmentStart[s]; }
+    size_t getNumSynapses() const{ return ind.size(); }
+    unsigned int getMaxDelay() const
+    {
+        return segmentDelay.empty() ? 0 : *std::max_element(segmentDelay.begin(), segmentDelay.end());
+    }
+};
+
+//! Delays in [minDelay, maxDelay], drawn uniformly for each synapse of
+//! matrix from Philox stream (seed, stream, pre)
+inline std::vector<unsigned int> getUniformDelays(const RaggedMatrix &matrix, unsigned int minDelay, unsigned int maxDelay,
+                                                  uint32_t seed, uint32_t stream)
+{
+    std::vector<unsigned int> delays(matrix.getNumSynapses(), minDelay);
+    if(maxDelay > minDelay) {
+        const unsigned int range = maxDelay - minDelay + 1;
+        for(unsigned int pre = 0; pre < matrix.numPre; pre++) {
+            const unsigned int rowStart = matrix.rowStart[pre];
+            if(matrix.getRowLength(pre) == 0) {
+                continue;
+            }
+            Philox::fillBits(seed, stream, pre, 0, matrix.getRowLength(pre), reinterpret_cast<uint32_t*>(&delays[rowStart]));
+            for(unsigned int j = rowStart; j < matrix.rowStart[pre + 1]; j++) {
+                delays[j] = minDelay + (unsigned int)(((uint64_t)delays[j] * range) >> 32);
+            }
+        }
+    }
+    return delays;
+}
+
+//! Split matrix, whose synapse j has delay delays[j], into segments. Each
+//! row's segments are in ascending order of delay and keep the order of
+//! the row's synapses
+inline void splitByDelay(const RaggedMatrix &matrix, const std::vector<unsigned int> &delays, DelayedMatrix &delayed)
+{
+    delayed.numPre = matrix.numPre;
+    delayed.numPost = matrix.numPost;
+    delayed.rowSegments.assign(1, 0);
+    delayed.segmentStart.assign(1, 0);
+    delayed.segmentDelay.clear();
+    delayed.segmentPre.clear();
+    delayed.ind.clear();
+    delayed.g.clear();
+    delayed.ind.reserve(matrix.getNumSynapses());
+    delayed.g.reserve(matrix.getNumSynapses());
+
+    std::vector<unsigned int> order;
+    for(unsigned int pre = 0; pre < matrix.numPre; pre++) {
+        order.resize(matrix.getRowLength(pre));
+        for(unsigned int k = 0; k < order.size(); k++) {
+            order[k] = matrix.rowStart[pre] + k;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&delays](unsigned int a, unsigned int b){ return delays[a] < delays[b]; });
+
+        for(unsigned int k = 0; k < order.size(); k++) {
+            const unsigned int j = order[k];
+            if(k == 0 || delays[j] != delays[order[k - 1]]) {
+                if(k != 0) {
+                    delayed.segmentStart.push_back((unsigned int)delayed.ind.size());
+                }
+                delayed.segmentDelay.push_back(delays[j]);
+                delayed.segmentPre.push_back(pre);
+            }
+            delayed.ind.push_back(matrix.ind[j]);
+            delayed.g.push_back(matrix.g[j]);
+        }
+        if(!order.empty()) {
+            delayed.segmentStart.push_back((unsigned int)delayed.ind.size());
+        }
+        delayed.rowSegments.push_back((unsigned int)delayed.segmentDelay.size());
+    }
+}
+
+//------------------------------------------------------------------------
+// SNNBench::DelayQueue
+//------------------------------------------------------------------------
+//! Ring of per-delay buckets of DelayedMatrix segments. Each step the
+//! segments due are delivered and cleared, then the segments of the
+//! step's spikes are pushed into the bucket of their arrival step, so a
+//! synaptic event costs the same whatever the spread of delays
+class DelayQueue
+{
+public:
+    DelayQueue(unsigned int maxDelay = 0)
+    :   m_Buckets(maxDelay + 1), m_Current(0)
+    {
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Segments arriving this step
+    const std::vector<unsigned int> &getDue() const{ return m_Buckets[m_Current]; }
+
+    //! Forget the segments of this step once they have been delivered
+    void clearDue(){ m_Buckets[m_Current].clear(); }
+
+    //! Schedule every segment of pre, which spiked this step
+    void push(const DelayedMatrix &matrix, unsigned int pre)
+    {
+        for(unsigned int s = matrix.rowSegments[pre]; s < matrix.rowSegments[pre + 1]; s++) {
+            push(s, matrix.segmentDelay[s]);
+        }
+    }
+
+    //! Schedule any other entry (such as a presynaptic neuron whose synapses
+    //! all share one delay) for delay + 1 steps from now
+    void push(unsigned int entry, unsigned int delay)
+    {
+        m_Buckets[(m_Current + delay + 1) % m_Buckets.size()].push_back(entry);
+    }
+
+    void advance(){ m_Current = (m_Current + 1) % m_Buckets.size(); }
+
+    unsigned int getNumBuckets() const{ return (unsigned int)m_Buckets.size(); }
+
+    //! Entries in flight as a flat array, for checkpoints: the current
+    //! bucket and number of buckets, then each bucket's size and entries
+    std::vector<unsigned int> getState() const
+    {
+        std::vector<unsigned int> state{m_Current, (unsigned int)m_Buckets.size()};
+        for(const auto &b : m_Buckets) {
+            state.push_back((unsigned int)b.size());
+            state.insert(state.end(), b.begin(), b.end());
+        }
+        return state;
+    }
+
+    //! Restore the entries of getState, returning false if it was taken
+    //! from a queue with a different number of buckets
+    bool setState(const std::vector<unsigned int> &state)
+    {
+        if(state.size() < 2 || state[0] >= m_Buckets.size() || state[1] != m_Buckets.size()) {
+            return false;
+        }
+        size_t i = 2;
+        for(auto &b : m_Buckets) {
+            if(i >= state.size() || (state.size() - i - 1) < state[i]) {
+                return false;
+            }
+            b.assign(state.begin() + i + 1, state.begin() + i + 1 + state[i]);
+            i += 1 + state[i];
+        }
+        m_Current = state[0];
+        return i == state.size();
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    std::vector<std::vector<unsigned int>> m_Buckets;
+    unsigned int m_Current;
+};
+} // SNNBench
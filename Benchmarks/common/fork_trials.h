@@ -0,0 +1,116 @@
+#pragma once
+
+// Standard C++ includes
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+// POSIX includes
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Shared benchmark utilities
+#include "thread_pool.h"
+
+namespace SNNBench {
+namespace ForkTrials {
+//------------------------------------------------------------------------
+// SNNBench::ForkTrials::Result
+//------------------------------------------------------------------------
+//! What a trial reports back to the parent: the duration of its timed
+//! loop and the synaptic events it delivered
+struct Result
+{
+    bool succeeded;
+    double simSeconds;
+    double numEvents;
+};
+
+//------------------------------------------------------------------------
+// Free functions
+//------------------------------------------------------------------------
+//! Run numTrials timing trials of a network that has already been built
+//! and loaded, each in a child process forked from this one so it starts
+//! from a copy-on-write image of the initialised network rather than
+//! repeating the setup. Children run one at a time, so trials don't
+//! compete for CPUs, and call trial(index) with pool's workers restarted,
+//! returning its Result over a pipe. A child that fails or dies gives a
+//! Result with succeeded false
+template<typename F>
+std::vector<Result> run(unsigned int numTrials, ThreadPool &pool, F trial)
+{
+    // Threads other than the caller's are not inherited by a child
+    pool.stopWorkers();
+
+    std::vector<Result> results;
+    for(unsigned int t = 0; t < numTrials; t++) {
+        int fds[2];
+        if(pipe(fds) != 0) {
+            perror("pipe");
+            break;
+        }
+
+        // Avoid the child inheriting (and re-printing) buffered output
+        fflush(stdout);
+        fflush(stderr);
+        const pid_t pid = fork();
+        if(pid < 0) {
+            perror("fork");
+            close(fds[0]);
+            close(fds[1]);
+            break;
+        }
+        else if(pid == 0) {
+            close(fds[0]);
+            pool.startWorkers();
+            Result result = trial(t);
+            result.succeeded = true;
+            const bool written = (write(fds[1], &result, sizeof(Result)) == (ssize_t)sizeof(Result));
+            fflush(stdout);
+            fflush(stderr);
+            _exit(written ? 0 : 1);
+        }
+
+        close(fds[1]);
+        Result result{false, 0.0, 0.0};
+        Result received;
+        const bool haveResult = (read(fds[0], &received, sizeof(Result)) == (ssize_t)sizeof(Result));
+        close(fds[0]);
+
+        int status = 0;
+        if(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0 && haveResult) {
+            result = received;
+        }
+        else {
+            fprintf(stderr, "Trial %u failed\n", t);
+        }
+        results.push_back(result);
+    }
+
+    pool.startWorkers();
+    return results;
+}
+
+//! Print the trials' timings and write them to filename, one trial per line
+//! as "sim_seconds events" (the per-trial form of timefile.dat and
+//! eventsfile.dat). Returns false if any trial failed
+inline bool report(const std::vector<Result> &results, const std::string &filename)
+{
+    std::ofstream stream(filename);
+    bool succeeded = true;
+    for(size_t t = 0; t < results.size(); t++) {
+        const Result &r = results[t];
+        if(r.succeeded) {
+            printf("Trial %zu: %.4fs, %.3g synaptic events/s\n", t, r.simSeconds, r.numEvents / r.simSeconds);
+            stream << std::setprecision(10) << r.simSeconds << " " << r.numEvents << std::endl;
+        }
+        else {
+            succeeded = false;
+        }
+    }
+    return succeeded;
+}
+} // ForkTrials
+} // SNNBench
@@ -0,0 +1,440 @@
+#pragma once
+
+// Standard C++ includes
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+// Shared benchmark utilities
+#include "simd.h"
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::LIFKernels
+//------------------------------------------------------------------------
+//! Neuron update kernels of the native engines: the LIF dynamics of
+//! genn/lif.h (VA with ExpCond input, Brunel with DeltaCurr input) in
+//! scalar, AVX2 (8 neurons) and AVX-512 (16 neurons) versions. The vector
+//! versions turn the refractory and threshold branches into masks and
+//! compress the indices of spiking neurons straight into the spike list,
+//! which must have room for VectorSlack entries beyond the neurons
+//! updated. Every version performs the same float operations in the same
+//! order so, as long as FMA contraction is off (the default with
+//! -std=c++11), they produce identical results.
+//!
+//! Both integrators of genn/lif.h share one form, V += k * (V_inf - V) with
+//! the input held constant over the step: k = DT / TauM for LIF's forward
+//! Euler and k = 1 - ExpTC for LIFExact's exact propagator
+namespace LIFKernels
+{
+enum class Integrator
+{
+    Euler,
+    Exact,
+};
+
+using SIMD::ISA;
+using SIMD::detect;
+using SIMD::getName;
+using SIMD::select;
+
+// Spike lists must have this many entries of slack for compress-stores
+const unsigned int VectorSlack = 16;
+
+//------------------------------------------------------------------------
+// SNNBench::LIFKernels::ExpCondParams
+//------------------------------------------------------------------------
+//! Constants of the VA neuron update, derived once per run
+struct ExpCondParams
+{
+    float membraneStep;     // Fraction of the way to steady state covered per step
+    float rmembrane;
+    float vRest;
+    float vReset;
+    float vThresh;
+    float ioffset;
+    float tauRefrac;
+    float dt;
+    float erevExc;
+    float erevInh;
+    float expDecayExc;
+    float expDecayInh;
+};
+
+//------------------------------------------------------------------------
+// SNNBench::LIFKernels::DeltaParams
+//------------------------------------------------------------------------
+//! Constants of the Brunel neuron update
+struct DeltaParams
+{
+    float membraneStep;     // Fraction of the way to steady state covered per step
+    float vRest;
+    float vReset;
+    float vThresh;
+    float ioffset;
+    float tauRefrac;
+    float dt;
+};
+
+inline const char *getName(Integrator integrator)
+{
+    return (integrator == Integrator::Exact) ? "exact" : "euler";
+}
+
+//! Parse "euler" or "exact", returning false for anything else
+inline bool selectIntegrator(const std::string &name, Integrator &integrator)
+{
+    if(name == "euler") {
+        integrator = Integrator::Euler;
+        return true;
+    }
+    else if(name == "exact") {
+        integrator = Integrator::Exact;
+        return true;
+    }
+    return false;
+}
+
+//! membraneStep of a neuron with time constant tauM [ms] at timestep dt [ms]
+inline float getMembraneStep(Integrator integrator, double dt, double tauM)
+{
+    return (integrator == Integrator::Exact) ? (float)(1.0 - std::exp(-dt / tauM)) : (float)dt / (float)tauM;
+}
+
+//------------------------------------------------------------------------
+// Scalar kernels
+//------------------------------------------------------------------------
+//! GeNN's LIF sim code, threshold and reset with ExpCond input followed by
+//! the ExpCond decay, for neurons [begin, end). Returns the number of
+//! spiking neurons written to spikes
+inline unsigned int updateExpCondScalar(const ExpCondParams &p, float *v, float *refracTime, float *inSynExc,
+                                        float *inSynInh, unsigned int begin, unsigned int end, unsigned int *spikes)
+{
+    unsigned int numSpikes = 0;
+    for(unsigned int i = begin; i < end; i++) {
+        float vi = v[i];
+        float ri = refracTime[i];
+        const float isyn = (inSynExc[i] * (p.erevExc - vi)) + (inSynInh[i] * (p.erevInh - vi));
+
+        if(ri <= 0.0f) {
+            const float alpha = isyn * p.rmembrane;
+            vi += p.membraneStep * ((p.vRest - vi) + alpha + p.ioffset);
+        }
+        else {
+            ri -= p.dt;
+        }
+
+        if(ri <= 0.0f && vi >= p.vThresh) {
+            spikes[numSpikes++] = i;
+            vi = p.vReset;
+            ri = p.tauRefrac;
+        }
+
+        v[i] = vi;
+        refracTime[i] = ri;
+        inSynExc[i] *= p.expDecayExc;
+        inSynInh[i] *= p.expDecayInh;
+    }
+    return numSpikes;
+}
+
+//! GeNN's LIF sim code, threshold and reset with DeltaCurr input (which is
+//! consumed) for neurons [begin, end)
+inline unsigned int updateDeltaScalar(const DeltaParams &p, float *v, float *refracTime, float *inSyn,
+                                      unsigned int begin, unsigned int end, unsigned int *spikes)
+{
+    unsigned int numSpikes = 0;
+    for(unsigned int i = begin; i < end; i++) {
+        float vi = v[i];
+        float ri = refracTime[i];
+        const float isyn = inSyn[i];
+        inSyn[i] = 0.0f;
+
+        if(ri <= 0.0f) {
+            vi += (p.membraneStep * ((p.vRest - vi) + p.ioffset)) + isyn;
+        }
+        else {
+            ri -= p.dt;
+        }
+
+        if(ri <= 0.0f && vi >= p.vThresh) {
+            spikes[numSpikes++] = i;
+            vi = p.vReset;
+            ri = p.tauRefrac;
+        }
+
+        v[i] = vi;
+        refracTime[i] = ri;
+    }
+    return numSpikes;
+}
+
+#ifdef SNNBENCH_X86_SIMD
+//------------------------------------------------------------------------
+// AVX2 kernels
+//------------------------------------------------------------------------
+//! Permutations moving the set lanes of each 8-bit mask to the front,
+//! standing in for the compress-store AVX2 lacks
+struct CompressTable
+{
+    CompressTable()
+    {
+        for(unsigned int mask = 0; mask < 256; mask++) {
+            unsigned int n = 0;
+            for(unsigned int lane = 0; lane < 8; lane++) {
+                if(mask & (1u << lane)) {
+                    permutations[(mask * 8) + n++] = lane;
+                }
+            }
+            while(n < 8) {
+                permutations[(mask * 8) + n++] = 0;
+            }
+        }
+    }
+
+    uint32_t permutations[256 * 8];
+};
+
+inline const uint32_t *getCompressTable()
+{
+    // Function-local static so initialisation is thread-safe
+    static const CompressTable table;
+    return table.permutations;
+}
+
+__attribute__((target("avx2")))
+inline unsigned int compressStoreAVX2(__m256i indices, unsigned int mask, const uint32_t *table, unsigned int *out)
+{
+    const __m256i perm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&table[mask * 8]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permutevar8x32_epi32(indices, perm));
+    return (unsigned int)__builtin_popcount(mask);
+}
+
+__attribute__((target("avx2")))
+inline unsigned int updateExpCondAVX2(const ExpCondParams &p, float *v, float *refracTime, float *inSynExc,
+                                      float *inSynInh, unsigned int begin, unsigned int end, unsigned int *spikes)
+{
+    const uint32_t *table = getCompressTable();
+    const __m256 membraneStep = _mm256_set1_ps(p.membraneStep);
+    const __m256 rmembrane = _mm256_set1_ps(p.rmembrane);
+    const __m256 vRest = _mm256_set1_ps(p.vRest);
+    const __m256 vReset = _mm256_set1_ps(p.vReset);
+    const __m256 vThresh = _mm256_set1_ps(p.vThresh);
+    const __m256 ioffset = _mm256_set1_ps(p.ioffset);
+    const __m256 tauRefrac = _mm256_set1_ps(p.tauRefrac);
+    const __m256 dt = _mm256_set1_ps(p.dt);
+    const __m256 erevExc = _mm256_set1_ps(p.erevExc);
+    const __m256 erevInh = _mm256_set1_ps(p.erevInh);
+    const __m256 expDecayExc = _mm256_set1_ps(p.expDecayExc);
+    const __m256 expDecayInh = _mm256_set1_ps(p.expDecayInh);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    unsigned int numSpikes = 0;
+    unsigned int i = begin;
+    for(; (i + 8) <= end; i += 8) {
+        __m256 vi = _mm256_loadu_ps(&v[i]);
+        __m256 ri = _mm256_loadu_ps(&refracTime[i]);
+        const __m256 ge = _mm256_loadu_ps(&inSynExc[i]);
+        const __m256 gi = _mm256_loadu_ps(&inSynInh[i]);
+        const __m256 isyn = _mm256_add_ps(_mm256_mul_ps(ge, _mm256_sub_ps(erevExc, vi)),
+                                          _mm256_mul_ps(gi, _mm256_sub_ps(erevInh, vi)));
+
+        // Integrate non-refractory neurons, count down the rest
+        const __m256 active = _mm256_cmp_ps(ri, zero, _CMP_LE_OQ);
+        const __m256 alpha = _mm256_mul_ps(isyn, rmembrane);
+        const __m256 dv = _mm256_mul_ps(membraneStep, _mm256_add_ps(_mm256_add_ps(_mm256_sub_ps(vRest, vi), alpha), ioffset));
+        vi = _mm256_blendv_ps(vi, _mm256_add_ps(vi, dv), active);
+        ri = _mm256_blendv_ps(_mm256_sub_ps(ri, dt), ri, active);
+
+        const __m256 spike = _mm256_and_ps(_mm256_cmp_ps(ri, zero, _CMP_LE_OQ), _mm256_cmp_ps(vi, vThresh, _CMP_GE_OQ));
+        const unsigned int mask = (unsigned int)_mm256_movemask_ps(spike);
+        if(mask != 0) {
+            vi = _mm256_blendv_ps(vi, vReset, spike);
+            ri = _mm256_blendv_ps(ri, tauRefrac, spike);
+            const __m256i indices = _mm256_add_epi32(_mm256_set1_epi32((int)i), laneOffsets);
+            numSpikes += compressStoreAVX2(indices, mask, table, &spikes[numSpikes]);
+        }
+
+        _mm256_storeu_ps(&v[i], vi);
+        _mm256_storeu_ps(&refracTime[i], ri);
+        _mm256_storeu_ps(&inSynExc[i], _mm256_mul_ps(ge, expDecayExc));
+        _mm256_storeu_ps(&inSynInh[i], _mm256_mul_ps(gi, expDecayInh));
+    }
+    return numSpikes + updateExpCondScalar(p, v, refracTime, inSynExc, inSynInh, i, end, &spikes[numSpikes]);
+}
+
+__attribute__((target("avx2")))
+inline unsigned int updateDeltaAVX2(const DeltaParams &p, float *v, float *refracTime, float *inSyn,
+                                    unsigned int begin, unsigned int end, unsigned int *spikes)
+{
+    const uint32_t *table = getCompressTable();
+    const __m256 membraneStep = _mm256_set1_ps(p.membraneStep);
+    const __m256 vRest = _mm256_set1_ps(p.vRest);
+    const __m256 vReset = _mm256_set1_ps(p.vReset);
+    const __m256 vThresh = _mm256_set1_ps(p.vThresh);
+    const __m256 ioffset = _mm256_set1_ps(p.ioffset);
+    const __m256 tauRefrac = _mm256_set1_ps(p.tauRefrac);
+    const __m256 dt = _mm256_set1_ps(p.dt);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    unsigned int numSpikes = 0;
+    unsigned int i = begin;
+    for(; (i + 8) <= end; i += 8) {
+        __m256 vi = _mm256_loadu_ps(&v[i]);
+        __m256 ri = _mm256_loadu_ps(&refracTime[i]);
+        const __m256 isyn = _mm256_loadu_ps(&inSyn[i]);
+        _mm256_storeu_ps(&inSyn[i], zero);
+
+        const __m256 active = _mm256_cmp_ps(ri, zero, _CMP_LE_OQ);
+        const __m256 dv = _mm256_add_ps(_mm256_mul_ps(membraneStep, _mm256_add_ps(_mm256_sub_ps(vRest, vi), ioffset)), isyn);
+        vi = _mm256_blendv_ps(vi, _mm256_add_ps(vi, dv), active);
+        ri = _mm256_blendv_ps(_mm256_sub_ps(ri, dt), ri, active);
+
+        const __m256 spike = _mm256_and_ps(_mm256_cmp_ps(ri, zero, _CMP_LE_OQ), _mm256_cmp_ps(vi, vThresh, _CMP_GE_OQ));
+        const unsigned int mask = (unsigned int)_mm256_movemask_ps(spike);
+        if(mask != 0) {
+            vi = _mm256_blendv_ps(vi, vReset, spike);
+            ri = _mm256_blendv_ps(ri, tauRefrac, spike);
+            const __m256i indices = _mm256_add_epi32(_mm256_set1_epi32((int)i), laneOffsets);
+            numSpikes += compressStoreAVX2(indices, mask, table, &spikes[numSpikes]);
+        }
+
+        _mm256_storeu_ps(&v[i], vi);
+        _mm256_storeu_ps(&refracTime[i], ri);
+    }
+    return numSpikes + updateDeltaScalar(p, v, refracTime, inSyn, i, end, &spikes[numSpikes]);
+}
+
+//------------------------------------------------------------------------
+// AVX-512 kernels
+//------------------------------------------------------------------------
+__attribute__((target("avx512f")))
+inline unsigned int updateExpCondAVX512(const ExpCondParams &p, float *v, float *refracTime, float *inSynExc,
+                                        float *inSynInh, unsigned int begin, unsigned int end, unsigned int *spikes)
+{
+    const __m512 membraneStep = _mm512_set1_ps(p.membraneStep);
+    const __m512 rmembrane = _mm512_set1_ps(p.rmembrane);
+    const __m512 vRest = _mm512_set1_ps(p.vRest);
+    const __m512 vReset = _mm512_set1_ps(p.vReset);
+    const __m512 vThresh = _mm512_set1_ps(p.vThresh);
+    const __m512 ioffset = _mm512_set1_ps(p.ioffset);
+    const __m512 tauRefrac = _mm512_set1_ps(p.tauRefrac);
+    const __m512 dt = _mm512_set1_ps(p.dt);
+    const __m512 erevExc = _mm512_set1_ps(p.erevExc);
+    const __m512 erevInh = _mm512_set1_ps(p.erevInh);
+    const __m512 expDecayExc = _mm512_set1_ps(p.expDecayExc);
+    const __m512 expDecayInh = _mm512_set1_ps(p.expDecayInh);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512i laneOffsets = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    unsigned int numSpikes = 0;
+    unsigned int i = begin;
+    for(; (i + 16) <= end; i += 16) {
+        __m512 vi = _mm512_loadu_ps(&v[i]);
+        __m512 ri = _mm512_loadu_ps(&refracTime[i]);
+        const __m512 ge = _mm512_loadu_ps(&inSynExc[i]);
+        const __m512 gi = _mm512_loadu_ps(&inSynInh[i]);
+        const __m512 isyn = _mm512_add_ps(_mm512_mul_ps(ge, _mm512_sub_ps(erevExc, vi)),
+                                          _mm512_mul_ps(gi, _mm512_sub_ps(erevInh, vi)));
+
+        // Integrate non-refractory neurons, count down the rest
+        const __mmask16 active = _mm512_cmp_ps_mask(ri, zero, _CMP_LE_OQ);
+        const __m512 alpha = _mm512_mul_ps(isyn, rmembrane);
+        const __m512 dv = _mm512_mul_ps(membraneStep, _mm512_add_ps(_mm512_add_ps(_mm512_sub_ps(vRest, vi), alpha), ioffset));
+        vi = _mm512_mask_add_ps(vi, active, vi, dv);
+        ri = _mm512_mask_sub_ps(ri, (__mmask16)~active, ri, dt);
+
+        const __mmask16 spike = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(ri, zero, _CMP_LE_OQ), vi, vThresh, _CMP_GE_OQ);
+        if(spike != 0) {
+            vi = _mm512_mask_mov_ps(vi, spike, vReset);
+            ri = _mm512_mask_mov_ps(ri, spike, tauRefrac);
+            const __m512i indices = _mm512_add_epi32(_mm512_set1_epi32((int)i), laneOffsets);
+            _mm512_mask_compressstoreu_epi32(&spikes[numSpikes], spike, indices);
+            numSpikes += (unsigned int)__builtin_popcount(spike);
+        }
+
+        _mm512_storeu_ps(&v[i], vi);
+        _mm512_storeu_ps(&refracTime[i], ri);
+        _mm512_storeu_ps(&inSynExc[i], _mm512_mul_ps(ge, expDecayExc));
+        _mm512_storeu_ps(&inSynInh[i], _mm512_mul_ps(gi, expDecayInh));
+    }
+    return numSpikes + updateExpCondScalar(p, v, refracTime, inSynExc, inSynInh, i, end, &spikes[numSpikes]);
+}
+
+__attribute__((target("avx512f")))
+inline unsigned int updateDeltaAVX512(const DeltaParams &p, float *v, float *refracTime, float *inSyn,
+                                      unsigned int begin, unsigned int end, unsigned int *spikes)
+{
+    const __m512 membraneStep = _mm512_set1_ps(p.membraneStep);
+    const __m512 vRest = _mm512_set1_ps(p.vRest);
+    const __m512 vReset = _mm512_set1_ps(p.vReset);
+    const __m512 vThresh = _mm512_set1_ps(p.vThresh);
+    const __m512 ioffset = _mm512_set1_ps(p.ioffset);
+    const __m512 tauRefrac = _mm512_set1_ps(p.tauRefrac);
+    const __m512 dt = _mm512_set1_ps(p.dt);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512i laneOffsets = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    unsigned int numSpikes = 0;
+    unsigned int i = begin;
+    for(; (i + 16) <= end; i += 16) {
+        __m512 vi = _mm512_loadu_ps(&v[i]);
+        __m512 ri = _mm512_loadu_ps(&refracTime[i]);
+        const __m512 isyn = _mm512_loadu_ps(&inSyn[i]);
+        _mm512_storeu_ps(&inSyn[i], zero);
+
+        const __mmask16 active = _mm512_cmp_ps_mask(ri, zero, _CMP_LE_OQ);
+        const __m512 dv = _mm512_add_ps(_mm512_mul_ps(membraneStep, _mm512_add_ps(_mm512_sub_ps(vRest, vi), ioffset)), isyn);
+        vi = _mm512_mask_add_ps(vi, active, vi, dv);
+        ri = _mm512_mask_sub_ps(ri, (__mmask16)~active, ri, dt);
+
+        const __mmask16 spike = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(ri, zero, _CMP_LE_OQ), vi, vThresh, _CMP_GE_OQ);
+        if(spike != 0) {
+            vi = _mm512_mask_mov_ps(vi, spike, vReset);
+            ri = _mm512_mask_mov_ps(ri, spike, tauRefrac);
+            const __m512i indices = _mm512_add_epi32(_mm512_set1_epi32((int)i), laneOffsets);
+            _mm512_mask_compressstoreu_epi32(&spikes[numSpikes], spike, indices);
+            numSpikes += (unsigned int)__builtin_popcount(spike);
+        }
+
+        _mm512_storeu_ps(&v[i], vi);
+        _mm512_storeu_ps(&refracTime[i], ri);
+    }
+    return numSpikes + updateDeltaScalar(p, v, refracTime, inSyn, i, end, &spikes[numSpikes]);
+}
+#endif  // SNNBENCH_X86_SIMD
+
+//------------------------------------------------------------------------
+// Dispatch
+//------------------------------------------------------------------------
+inline unsigned int updateExpCond(ISA isa, const ExpCondParams &p, float *v, float *refracTime, float *inSynExc,
+                                  float *inSynInh, unsigned int begin, unsigned int end, unsigned int *spikes)
+{
+#ifdef SNNBENCH_X86_SIMD
+    if(isa == ISA::AVX512) {
+        return updateExpCondAVX512(p, v, refracTime, inSynExc, inSynInh, begin, end, spikes);
+    }
+    else if(isa == ISA::AVX2) {
+        return updateExpCondAVX2(p, v, refracTime, inSynExc, inSynInh, begin, end, spikes);
+    }
+#endif
+    return updateExpCondScalar(p, v, refracTime, inSynExc, inSynInh, begin, end, spikes);
+}
+
+inline unsigned int updateDelta(ISA isa, const DeltaParams &p, float *v, float *refracTime, float *inSyn,
+                                unsigned int begin, unsigned int end, unsigned int *spikes)
+{
+#ifdef SNNBENCH_X86_SIMD
+    if(isa == ISA::AVX512) {
+        return updateDeltaAVX512(p, v, refracTime, inSyn, begin, end, spikes);
+    }
+    else if(isa == ISA::AVX2) {
+        return updateDeltaAVX2(p, v, refracTime, inSyn, begin, end, spikes);
+    }
+#endif
+    return updateDeltaScalar(p, v, refracTime, inSyn, begin, end, spikes);
+}
+} // LIFKernels
+} // SNNBench
@@ -0,0 +1,307 @@
+#pragma once
+
+// Standard C++ includes
+#include <cmath>
+#include <cstdint>
+
+// Shared benchmark utilities
+#include "simd.h"
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::Philox
+//------------------------------------------------------------------------
+//! Counter-based Philox4x32-10 random numbers (Salmon et al., SC'11). The
+//! value i of (seed, stream, step) is a pure function of those four
+//! numbers: word i % 4 of the block produced from key (seed, stream) and
+//! counter (i / 4, step). Any range of values can therefore be filled
+//! independently, by any thread and in any order, with identical results
+//! and no per-neuron generator state. The batch fills generate 8 (AVX2)
+//! or 16 (AVX-512) blocks at a time and agree bit-for-bit with the scalar
+//! path. Stream numbers separate the users of one seed, steps typically
+//! are timesteps or row indices
+namespace Philox
+{
+const uint32_t M0 = 0xD2511F53;
+const uint32_t M1 = 0xCD9E8D57;
+const uint32_t W0 = 0x9E3779B9;
+const uint32_t W1 = 0xBB67AE85;
+const unsigned int NumRounds = 10;
+
+//! Block number block of (seed, stream, step)
+inline void generateBlock(uint32_t seed, uint32_t stream, uint64_t step, uint32_t block, uint32_t out[4])
+{
+    uint32_t c0 = block;
+    uint32_t c1 = (uint32_t)step;
+    uint32_t c2 = (uint32_t)(step >> 32);
+    uint32_t c3 = 0;
+    uint32_t k0 = seed;
+    uint32_t k1 = stream;
+    for(unsigned int r = 0; r < NumRounds; r++) {
+        const uint64_t p0 = (uint64_t)M0 * c0;
+        const uint64_t p1 = (uint64_t)M1 * c2;
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        c1 = (uint32_t)p1;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c3 = (uint32_t)p0;
+        k0 += W0;
+        k1 += W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+//! Uniform float in (0, 1] from the top 24 bits
+inline float toUniform(uint32_t bits)
+{
+    return (float)((bits >> 8) + 1) * (1.0f / 16777216.0f);
+}
+
+//! Uniform double in (0, 1] from all 32 bits
+inline double toUniformDouble(uint32_t bits)
+{
+    return ((double)bits + 1.0) * (1.0 / 4294967296.0);
+}
+
+//! Binomial(n, p) by inversion of its CDF, which needs about n * p + 1
+//! iterations, so suits the small means of per-step spike counts
+inline unsigned int toBinomial(float uniform, unsigned int n, float pmf0, float odds)
+{
+    unsigned int k = 0;
+    float pmf = pmf0;
+    while(uniform > pmf && k < n) {
+        uniform -= pmf;
+        pmf *= odds * (float)(n - k) / (float)(k + 1);
+        k++;
+    }
+    return k;
+}
+
+#ifdef SNNBENCH_X86_SIMD
+//------------------------------------------------------------------------
+// AVX2: 8 blocks, one per lane
+//------------------------------------------------------------------------
+__attribute__((target("avx2")))
+inline void mulHiLoAVX2(__m256i a, __m256i m, __m256i &hi, __m256i &lo)
+{
+    const __m256i evenProducts = _mm256_mul_epu32(a, m);
+    const __m256i oddProducts = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(evenProducts, 32), oddProducts, 0xAA);
+    lo = _mm256_mullo_epi32(a, m);
+}
+
+//! Write 8 whole blocks, starting with block firstBlock, to out
+__attribute__((target("avx2")))
+inline void generateBlocksAVX2(uint32_t seed, uint32_t stream, uint64_t step, uint32_t firstBlock, uint32_t *out)
+{
+    const __m256i m0 = _mm256_set1_epi32((int)M0);
+    const __m256i m1 = _mm256_set1_epi32((int)M1);
+    __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32((int)firstBlock), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i c1 = _mm256_set1_epi32((int)(uint32_t)step);
+    __m256i c2 = _mm256_set1_epi32((int)(uint32_t)(step >> 32));
+    __m256i c3 = _mm256_setzero_si256();
+    uint32_t k0 = seed;
+    uint32_t k1 = stream;
+    for(unsigned int r = 0; r < NumRounds; r++) {
+        __m256i hi0, lo0, hi1, lo1;
+        mulHiLoAVX2(c0, m0, hi0, lo0);
+        mulHiLoAVX2(c2, m1, hi1, lo1);
+        c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32((int)k0));
+        c1 = lo1;
+        c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32((int)k1));
+        c3 = lo0;
+        k0 += W0;
+        k1 += W1;
+    }
+
+    // Transpose from one word per vector to one block after another
+    const __m256i c01Lo = _mm256_unpacklo_epi32(c0, c1);
+    const __m256i c01Hi = _mm256_unpackhi_epi32(c0, c1);
+    const __m256i c23Lo = _mm256_unpacklo_epi32(c2, c3);
+    const __m256i c23Hi = _mm256_unpackhi_epi32(c2, c3);
+    const __m256i b04 = _mm256_unpacklo_epi64(c01Lo, c23Lo);
+    const __m256i b15 = _mm256_unpackhi_epi64(c01Lo, c23Lo);
+    const __m256i b26 = _mm256_unpacklo_epi64(c01Hi, c23Hi);
+    const __m256i b37 = _mm256_unpackhi_epi64(c01Hi, c23Hi);
+    __m256i *o = reinterpret_cast<__m256i*>(out);
+    _mm256_storeu_si256(o, _mm256_permute2x128_si256(b04, b15, 0x20));
+    _mm256_storeu_si256(o + 1, _mm256_permute2x128_si256(b26, b37, 0x20));
+    _mm256_storeu_si256(o + 2, _mm256_permute2x128_si256(b04, b15, 0x31));
+    _mm256_storeu_si256(o + 3, _mm256_permute2x128_si256(b26, b37, 0x31));
+}
+
+//------------------------------------------------------------------------
+// AVX-512: 16 blocks, one per lane
+//------------------------------------------------------------------------
+// GCC 12's AVX-512 headers trigger spurious -Wuninitialized warnings here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+__attribute__((target("avx512f")))
+inline void mulHiLoAVX512(__m512i a, __m512i m, __m512i &hi, __m512i &lo)
+{
+    const __m512i evenProducts = _mm512_mul_epu32(a, m);
+    const __m512i oddProducts = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), m);
+    hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(evenProducts, 32), oddProducts);
+    lo = _mm512_mullo_epi32(a, m);
+}
+
+//! Write 16 whole blocks, starting with block firstBlock, to out
+__attribute__((target("avx512f")))
+inline void generateBlocksAVX512(uint32_t seed, uint32_t stream, uint64_t step, uint32_t firstBlock, uint32_t *out)
+{
+    const __m512i m0 = _mm512_set1_epi32((int)M0);
+    const __m512i m1 = _mm512_set1_epi32((int)M1);
+    __m512i c0 = _mm512_add_epi32(_mm512_set1_epi32((int)firstBlock),
+                                  _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    __m512i c1 = _mm512_set1_epi32((int)(uint32_t)step);
+    __m512i c2 = _mm512_set1_epi32((int)(uint32_t)(step >> 32));
+    __m512i c3 = _mm512_setzero_si512();
+    uint32_t k0 = seed;
+    uint32_t k1 = stream;
+    for(unsigned int r = 0; r < NumRounds; r++) {
+        __m512i hi0, lo0, hi1, lo1;
+        mulHiLoAVX512(c0, m0, hi0, lo0);
+        mulHiLoAVX512(c2, m1, hi1, lo1);
+        c0 = _mm512_xor_si512(_mm512_xor_si512(hi1, c1), _mm512_set1_epi32((int)k0));
+        c1 = lo1;
+        c2 = _mm512_xor_si512(_mm512_xor_si512(hi0, c3), _mm512_set1_epi32((int)k1));
+        c3 = lo0;
+        k0 += W0;
+        k1 += W1;
+    }
+
+    // Transpose within 128-bit lanes (blocks l, l + 4, l + 8, l + 12 of b[l])
+    // and then gather four consecutive blocks into each output vector
+    const __m512i c01Lo = _mm512_unpacklo_epi32(c0, c1);
+    const __m512i c01Hi = _mm512_unpackhi_epi32(c0, c1);
+    const __m512i c23Lo = _mm512_unpacklo_epi32(c2, c3);
+    const __m512i c23Hi = _mm512_unpackhi_epi32(c2, c3);
+    const __m512i b0 = _mm512_unpacklo_epi64(c01Lo, c23Lo);
+    const __m512i b1 = _mm512_unpackhi_epi64(c01Lo, c23Lo);
+    const __m512i b2 = _mm512_unpacklo_epi64(c01Hi, c23Hi);
+    const __m512i b3 = _mm512_unpackhi_epi64(c01Hi, c23Hi);
+    const __m512i t0 = _mm512_shuffle_i32x4(b0, b1, 0x44);
+    const __m512i t1 = _mm512_shuffle_i32x4(b2, b3, 0x44);
+    const __m512i t2 = _mm512_shuffle_i32x4(b0, b1, 0xEE);
+    const __m512i t3 = _mm512_shuffle_i32x4(b2, b3, 0xEE);
+    _mm512_storeu_si512(out, _mm512_shuffle_i32x4(t0, t1, 0x88));
+    _mm512_storeu_si512(out + 16, _mm512_shuffle_i32x4(t0, t1, 0xDD));
+    _mm512_storeu_si512(out + 32, _mm512_shuffle_i32x4(t2, t3, 0x88));
+    _mm512_storeu_si512(out + 48, _mm512_shuffle_i32x4(t2, t3, 0xDD));
+}
+#pragma GCC diagnostic pop
+#endif  // SNNBENCH_X86_SIMD
+
+//------------------------------------------------------------------------
+// Batch API
+//------------------------------------------------------------------------
+//! Raw values [first, first + count) of (seed, stream, step)
+inline void fillBits(uint32_t seed, uint32_t stream, uint64_t step, uint32_t first, uint32_t count, uint32_t *out,
+                     SIMD::ISA isa = SIMD::detect())
+{
+    const uint32_t end = first + count;
+    uint32_t i = first;
+    uint32_t block[4];
+
+    // Leading partial block
+    if((i % 4) != 0) {
+        generateBlock(seed, stream, step, i / 4, block);
+        for(; (i % 4) != 0 && i < end; i++) {
+            *out++ = block[i % 4];
+        }
+    }
+
+#ifdef SNNBENCH_X86_SIMD
+    if(isa == SIMD::ISA::AVX512) {
+        for(; (i + 64) <= end; i += 64, out += 64) {
+            generateBlocksAVX512(seed, stream, step, i / 4, out);
+        }
+    }
+    if(isa != SIMD::ISA::Scalar) {
+        for(; (i + 32) <= end; i += 32, out += 32) {
+            generateBlocksAVX2(seed, stream, step, i / 4, out);
+        }
+    }
+#endif
+
+    // Remaining whole and partial blocks
+    for(; i < end; i += 4) {
+        generateBlock(seed, stream, step, i / 4, block);
+        for(uint32_t w = 0; w < 4 && (i + w) < end; w++) {
+            *out++ = block[w];
+        }
+    }
+}
+
+//! Uniform floats in (0, 1] for values [first, first + count)
+inline void fillUniform(uint32_t seed, uint32_t stream, uint64_t step, uint32_t first, uint32_t count, float *out,
+                        SIMD::ISA isa = SIMD::detect())
+{
+    uint32_t *bits = reinterpret_cast<uint32_t*>(out);
+    fillBits(seed, stream, step, first, count, bits, isa);
+    for(uint32_t i = 0; i < count; i++) {
+        out[i] = toUniform(bits[i]);
+    }
+}
+
+//! Exponentially distributed floats with mean 1 for values [first, first + count)
+inline void fillExponential(uint32_t seed, uint32_t stream, uint64_t step, uint32_t first, uint32_t count, float *out,
+                            SIMD::ISA isa = SIMD::detect())
+{
+    fillUniform(seed, stream, step, first, count, out, isa);
+    for(uint32_t i = 0; i < count; i++) {
+        out[i] = -std::log(out[i]);
+    }
+}
+
+//! Binomial(n, p) counts for values [first, first + count)
+inline void fillBinomial(uint32_t seed, uint32_t stream, uint64_t step, uint32_t first, uint32_t count,
+                         unsigned int n, float p, unsigned int *out, SIMD::ISA isa = SIMD::detect())
+{
+    static_assert(sizeof(unsigned int) == sizeof(uint32_t), "Binomial counts are generated in place");
+    fillBits(seed, stream, step, first, count, reinterpret_cast<uint32_t*>(out), isa);
+    const float pmf0 = (float)std::pow(1.0 - (double)p, (double)n);
+    const float odds = p / (1.0f - p);
+    for(uint32_t i = 0; i < count; i++) {
+        out[i] = toBinomial(toUniform(out[i]), n, pmf0, odds);
+    }
+}
+
+//------------------------------------------------------------------------
+// SNNBench::Philox::Stream
+//------------------------------------------------------------------------
+//! Sequential draws from (seed, stream, step), for consumers which don't
+//! know in advance how many values they need. Draw i equals value i of
+//! the batch fills
+class Stream
+{
+public:
+    Stream(uint32_t seed, uint32_t stream, uint64_t step)
+    :   m_Seed(seed), m_Stream(stream), m_Step(step), m_Block(0), m_Word(4)
+    {
+    }
+
+    uint32_t nextBits()
+    {
+        if(m_Word == 4) {
+            generateBlock(m_Seed, m_Stream, m_Step, m_Block++, m_Buffer);
+            m_Word = 0;
+        }
+        return m_Buffer[m_Word++];
+    }
+
+    float nextUniform(){ return toUniform(nextBits()); }
+    double nextUniformDouble(){ return toUniformDouble(nextBits()); }
+
+private:
+    const uint32_t m_Seed;
+    const uint32_t m_Stream;
+    const uint64_t m_Step;
+    uint32_t m_Block;
+    unsigned int m_Word;
+    uint32_t m_Buffer[4];
+};
+} // Philox
+} // SNNBench
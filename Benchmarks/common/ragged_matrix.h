@@ -0,0 +1,84 @@
+#pragma once
+
+// Standard C++ includes
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::RaggedMatrix
+//------------------------------------------------------------------------
+//! Row-compressed connectivity used by the native engines: the synapses of
+//! presynaptic neuron i are ind/g[rowStart[i], rowStart[i + 1])
+struct RaggedMatrix
+{
+    unsigned int numPre;
+    unsigned int numPost;
+    std::vector<unsigned int> rowStart;
+    std::vector<unsigned int> ind;
+    std::vector<float> g;
+
+    unsigned int getRowLength(unsigned int pre) const{ return rowStart[pre + 1] - rowStart[pre]; }
+    size_t getNumSynapses() const{ return ind.size(); }
+};
+
+//! Load an Auryn .wmat (MatrixMarket coordinate, 1-based, row major) file.
+//! Returns false if the file could not be read
+inline bool loadWmat(const std::string &filename, RaggedMatrix &matrix)
+{
+    std::ifstream weightfile(filename);
+    if(!weightfile.is_open()) {
+        fprintf(stderr, "Could not open connectivity file: %s\n", filename.c_str());
+        return false;
+    }
+    printf("Loading weights from mat file: %s\n", filename.c_str());
+
+    std::string line;
+    bool header = true;
+    std::vector<unsigned int> pres;
+    matrix.ind.clear();
+    matrix.g.clear();
+    while(std::getline(weightfile, line)) {
+        if(line.empty() || line[0] == '%') {
+            continue;
+        }
+
+        if(header) {
+            std::stringstream ss(line);
+            unsigned long long numSynapses;
+            ss >> matrix.numPre >> matrix.numPost >> numSynapses;
+            pres.reserve(numSynapses);
+            matrix.ind.reserve(numSynapses);
+            matrix.g.reserve(numSynapses);
+            header = false;
+            continue;
+        }
+
+        // Parsed directly as the Brunel files have millions of lines
+        const char *start = line.c_str();
+        char *next;
+        const unsigned long pre = strtoul(start, &next, 10);
+        const unsigned long post = strtoul(next, &next, 10);
+        const float weight = strtof(next, &next);
+        if(pre > 0 && post > 0) {
+            pres.push_back((unsigned int)pre - 1);
+            matrix.ind.push_back((unsigned int)post - 1);
+            matrix.g.push_back(weight);
+        }
+    }
+
+    // Rows are stored in order so only their starts need counting
+    matrix.rowStart.assign(matrix.numPre + 1, 0);
+    for(unsigned int p : pres) {
+        matrix.rowStart[p + 1]++;
+    }
+    for(unsigned int i = 0; i < matrix.numPre; i++) {
+        matrix.rowStart[i + 1] += matrix.rowStart[i];
+    }
+    return true;
+}
+} // SNNBench
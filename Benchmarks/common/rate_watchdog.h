@@ -0,0 +1,130 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::RateWatchdog
+//------------------------------------------------------------------------
+//! Guards a run against pathological activity. The spikes of each
+//! population are counted into a ring of per-step counts, and once a whole
+//! window has been simulated the population's rate over the last window is
+//! checked against [minRate, maxRate] Hz after every step, so a run that
+//! falls silent or into runaway synchrony can be stopped long before its
+//! simulation time is up. Like Auryn's RateChecker, but usable by any
+//! engine that can count its spikes each step, including in --fast mode
+class RateWatchdog
+{
+public:
+    //! Windows are windowMs long in steps of timestepMs
+    RateWatchdog(float minRate, float maxRate, float windowMs, double timestepMs)
+    :   m_MinRate(minRate), m_MaxRate(maxRate), m_TimestepMs(timestepMs),
+        m_WindowSteps(std::max(1u, (unsigned int)std::round(windowMs / timestepMs))), m_Step(0), m_Tripped(false),
+        m_TrippedPopulation(0), m_TrippedRate(0.0f)
+    {
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Watch a population of numNeurons, returning the index to count its spikes with
+    unsigned int addPopulation(const std::string &name, unsigned int numNeurons)
+    {
+        m_Populations.push_back({name, numNeurons, std::vector<unsigned int>(m_WindowSteps, 0), 0, 0});
+        return (unsigned int)(m_Populations.size() - 1);
+    }
+
+    //! Count spikes of population emitted this step
+    void addSpikes(unsigned int population, unsigned int count){ m_Populations[population].current += count; }
+
+    //! Finish the step, returning false if (and from when) any population's
+    //! rate over the last window has left the band
+    bool endStep()
+    {
+        const unsigned int slot = (unsigned int)(m_Step % m_WindowSteps);
+        m_Step++;
+        for(auto &p : m_Populations) {
+            p.windowCount += p.current;
+            p.windowCount -= p.counts[slot];
+            p.counts[slot] = p.current;
+            p.current = 0;
+        }
+
+        if(!m_Tripped && m_Step >= m_WindowSteps) {
+            for(unsigned int i = 0; i < m_Populations.size(); i++) {
+                const float rate = getRate(i);
+                if(rate < m_MinRate || rate > m_MaxRate) {
+                    m_Tripped = true;
+                    m_TrippedPopulation = i;
+                    m_TrippedRate = rate;
+                    break;
+                }
+            }
+        }
+        return !m_Tripped;
+    }
+
+    //! Mean rate [Hz] of population over the last window (or as much of it as has been simulated)
+    float getRate(unsigned int population) const
+    {
+        const auto &p = m_Populations[population];
+        const double windowSeconds = (double)std::min<unsigned long long>(m_Step, m_WindowSteps) * m_TimestepMs / 1000.0;
+        return (windowSeconds > 0.0 && p.numNeurons > 0) ? (float)((double)p.windowCount / ((double)p.numNeurons * windowSeconds)) : 0.0f;
+    }
+
+    //! Describe why the run was stopped, and every population's rate
+    void printDiagnostic(FILE *stream = stderr) const
+    {
+        if(!m_Tripped) {
+            return;
+        }
+        fprintf(stream, "Rate watchdog: %s rate of %.3gHz over the %.0fms up to %.1fms is outside [%g, %g]Hz, aborting\n",
+                m_Populations[m_TrippedPopulation].name.c_str(), m_TrippedRate, (double)m_WindowSteps * m_TimestepMs,
+                (double)m_Step * m_TimestepMs, m_MinRate, m_MaxRate);
+        for(unsigned int i = 0; i < m_Populations.size(); i++) {
+            fprintf(stream, "  %s (%u neurons): %.3gHz\n", m_Populations[i].name.c_str(), m_Populations[i].numNeurons, getRate(i));
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Static API
+    //------------------------------------------------------------------------
+    //! Parse a "min,max" band in Hz, returning false if it isn't one
+    static bool parseBand(const std::string &band, float &minRate, float &maxRate)
+    {
+        return (sscanf(band.c_str(), "%f,%f", &minRate, &maxRate) == 2) && (minRate <= maxRate);
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Population
+    //------------------------------------------------------------------------
+    struct Population
+    {
+        std::string name;
+        unsigned int numNeurons;
+        std::vector<unsigned int> counts;
+        unsigned long long windowCount;
+        unsigned int current;
+    };
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const float m_MinRate;
+    const float m_MaxRate;
+    const double m_TimestepMs;
+    const unsigned int m_WindowSteps;
+    std::vector<Population> m_Populations;
+    unsigned long long m_Step;
+
+    bool m_Tripped;
+    unsigned int m_TrippedPopulation;
+    float m_TrippedRate;
+};
+} // SNNBench
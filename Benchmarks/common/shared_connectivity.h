@@ -0,0 +1,318 @@
+#pragma once
+
+// Standard C++ includes
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Shared benchmark utilities
+#include "ragged_matrix.h"
+#include "trace.h"
+
+namespace SNNBench {
+namespace SharedConnectivity {
+//------------------------------------------------------------------------
+// SNNBench::SharedConnectivity::Header
+//------------------------------------------------------------------------
+//! Start of a segment, followed by the RaggedMatrix's rowStart, ind and g
+//! arrays. ready is set by the publishing process once the arrays are
+//! complete, so readers never see a half-written matrix. The publisher
+//! holds an exclusive flock on the segment until then, so a segment that
+//! is neither ready nor locked was abandoned by a publisher that died
+struct Header
+{
+    uint64_t magic;
+    std::atomic<uint32_t> ready;
+    uint32_t numPre;
+    uint32_t numPost;
+    uint64_t numSynapses;
+};
+
+//------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------
+// "SNNBCSR1" in ASCII, changed whenever the layout is
+static const uint64_t Magic = 0x31525343424E4E53ull;
+
+// How long to wait for another process that is publishing the same file
+static const double PublishTimeoutSeconds = 120.0;
+
+// How long a segment must stay unready and unlocked to count as abandoned,
+// covering the moment between a publisher creating and locking it
+static const double AbandonedSeconds = 0.5;
+
+//------------------------------------------------------------------------
+// SNNBench::SharedConnectivity::State
+//------------------------------------------------------------------------
+//! What a reader found in a segment
+enum class State
+{
+    Ready,      //!< Copied into the matrix
+    Publishing, //!< Not ready yet, but its publisher is still alive
+    Abandoned,  //!< Never going to be ready, as its publisher died
+    Invalid,    //!< Unusable, or still publishing after the timeout
+};
+
+//------------------------------------------------------------------------
+// Free functions
+//------------------------------------------------------------------------
+//! FNV-1a hash of a file's bytes as 16 hexadecimal digits, or an empty
+//! string if it can't be read
+inline std::string getFileHash(const std::string &filename)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if(!stream.good()) {
+        return "";
+    }
+    unsigned long long hash = 0xCBF29CE484222325ull;
+    std::vector<char> buffer(1 << 20);
+    while(stream.read(buffer.data(), buffer.size()) || stream.gcount() > 0) {
+        const std::streamsize count = stream.gcount();
+        for(std::streamsize i = 0; i < count; i++) {
+            hash = (hash ^ (unsigned char)buffer[i]) * 0x100000001B3ull;
+        }
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", hash);
+    return hex;
+}
+
+//! Name of the segment holding the parsed contents of a file with hash
+inline std::string getSegmentName(const std::string &hash)
+{
+    return "/snnbench-" + hash;
+}
+
+//! Size in bytes of a segment holding numPre rows of numSynapses synapses
+inline size_t getSegmentSize(uint32_t numPre, uint64_t numSynapses)
+{
+    return sizeof(Header) + ((size_t)(numPre + 1) * sizeof(unsigned int))
+        + ((size_t)numSynapses * (sizeof(unsigned int) + sizeof(float)));
+}
+
+//! Copy matrix into a new segment, which must have been created empty
+inline bool publishSegment(int fd, const RaggedMatrix &matrix)
+{
+    const size_t size = getSegmentSize(matrix.numPre, matrix.getNumSynapses());
+    if(ftruncate(fd, (off_t)size) != 0) {
+        perror("ftruncate");
+        return false;
+    }
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(data == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    Header *header = static_cast<Header*>(data);
+    header->magic = Magic;
+    header->numPre = matrix.numPre;
+    header->numPost = matrix.numPost;
+    header->numSynapses = matrix.getNumSynapses();
+    char *arrays = static_cast<char*>(data) + sizeof(Header);
+    const size_t rowStartBytes = matrix.rowStart.size() * sizeof(unsigned int);
+    const size_t indBytes = matrix.ind.size() * sizeof(unsigned int);
+    memcpy(arrays, matrix.rowStart.data(), rowStartBytes);
+    memcpy(arrays + rowStartBytes, matrix.ind.data(), indBytes);
+    memcpy(arrays + rowStartBytes + indBytes, matrix.g.data(), matrix.g.size() * sizeof(float));
+    header->ready.store(1, std::memory_order_release);
+
+    munmap(data, size);
+    return true;
+}
+
+//! Map a segment another process published read-only and, if it is
+//! ready, copy it into matrix
+inline State copySegment(int fd, RaggedMatrix &matrix)
+{
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        perror("fstat");
+        return State::Invalid;
+    }
+
+    // The publisher sizes the segment before it writes the header
+    const size_t size = (size_t)st.st_size;
+    if(size < sizeof(Header)) {
+        return State::Publishing;
+    }
+    void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if(data == MAP_FAILED) {
+        perror("mmap");
+        return State::Invalid;
+    }
+    const Header *header = static_cast<const Header*>(data);
+    State state = State::Publishing;
+    if(header->ready.load(std::memory_order_acquire)) {
+        state = ((header->magic == Magic) && (size == getSegmentSize(header->numPre, header->numSynapses)))
+            ? State::Ready : State::Invalid;
+        if(state == State::Ready) {
+            const unsigned int *rowStart = reinterpret_cast<const unsigned int*>(static_cast<const char*>(data) + sizeof(Header));
+            const unsigned int *ind = rowStart + header->numPre + 1;
+            const float *g = reinterpret_cast<const float*>(ind + header->numSynapses);
+            matrix.numPre = header->numPre;
+            matrix.numPost = header->numPost;
+            matrix.rowStart.assign(rowStart, rowStart + header->numPre + 1);
+            matrix.ind.assign(ind, ind + header->numSynapses);
+            matrix.g.assign(g, g + header->numSynapses);
+        }
+    }
+    munmap(data, size);
+    return state;
+}
+
+//! Copy a segment another process published into matrix, waiting for the
+//! publisher to finish for up to timeoutSeconds. Gives up early, returning
+//! Abandoned, if the segment stays unready with no publisher holding its lock
+inline State readSegment(int fd, RaggedMatrix &matrix, double timeoutSeconds)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto unlockedSince = start;
+    bool unlocked = false;
+    while(true) {
+        State state = copySegment(fd, matrix);
+        if(state != State::Publishing) {
+            return state;
+        }
+
+        // Test for a live publisher without blocking it for more than a moment
+        const auto now = std::chrono::steady_clock::now();
+        if(flock(fd, LOCK_SH | LOCK_NB) == 0) {
+            // The publisher may have finished since the segment was copied
+            state = copySegment(fd, matrix);
+            flock(fd, LOCK_UN);
+            if(state != State::Publishing) {
+                return state;
+            }
+            if(!unlocked) {
+                unlocked = true;
+                unlockedSince = now;
+            }
+            const std::chrono::duration<double> abandoned = now - unlockedSince;
+            if(abandoned.count() > AbandonedSeconds) {
+                return State::Abandoned;
+            }
+        }
+        else if(errno == EWOULDBLOCK) {
+            unlocked = false;
+        }
+        else {
+            perror("flock");
+            return State::Invalid;
+        }
+
+        const std::chrono::duration<double> waited = now - start;
+        if(waited.count() > timeoutSeconds) {
+            return State::Invalid;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+//! Unlink the abandoned segment open as fd, unless another process that
+//! found it abandoned already has (and perhaps published a new one)
+inline void removeAbandoned(const std::string &name, int fd)
+{
+    // Readers never take exclusive locks, so this only waits for other removers
+    if(flock(fd, LOCK_EX) != 0) {
+        perror("flock");
+        return;
+    }
+    const int currentFd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(currentFd >= 0) {
+        struct stat abandoned, current;
+        if(fstat(fd, &abandoned) == 0 && fstat(currentFd, &current) == 0
+            && abandoned.st_dev == current.st_dev && abandoned.st_ino == current.st_ino)
+        {
+            shm_unlink(name.c_str());
+        }
+        close(currentFd);
+    }
+    flock(fd, LOCK_UN);
+}
+
+//! loadWmat through a POSIX shared memory segment named after the hash of
+//! the file's contents. The first process to load a file parses it and
+//! publishes the row-compressed result; every later one (including those
+//! started while it is still parsing) copies it out of the segment instead
+//! of parsing. A segment abandoned by a publisher that died is removed and
+//! published again. Falls back to parsing whenever shared memory can't be
+//! used. Segments stay in /dev/shm/snnbench-* until they are removed
+inline bool loadWmat(const std::string &filename, RaggedMatrix &matrix)
+{
+    Trace::Scope trace("Load shared connectivity", "loader");
+
+    const std::string hash = getFileHash(filename);
+    if(hash.empty()) {
+        return SNNBench::loadWmat(filename, matrix);
+    }
+    const std::string name = getSegmentName(hash);
+
+    // Once an abandoned segment is removed, try again to publish or read
+    for(unsigned int attempt = 0; attempt < 2; attempt++) {
+        // Publish the file if no other process has, locking the segment until it's ready
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if(fd >= 0) {
+            if(flock(fd, LOCK_EX) != 0) {
+                perror("flock");
+                close(fd);
+                shm_unlink(name.c_str());
+                break;
+            }
+            if(!SNNBench::loadWmat(filename, matrix)) {
+                close(fd);
+                shm_unlink(name.c_str());
+                return false;
+            }
+            if(publishSegment(fd, matrix)) {
+                printf("Published %s as shared memory segment %s\n", filename.c_str(), name.c_str());
+            }
+            else {
+                shm_unlink(name.c_str());
+            }
+            close(fd);
+            return true;
+        }
+        else if(errno != EEXIST) {
+            perror("shm_open");
+            break;
+        }
+
+        // Otherwise copy the published segment, unless it was removed since
+        fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if(fd < 0) {
+            continue;
+        }
+        const State state = readSegment(fd, matrix, PublishTimeoutSeconds);
+        if(state == State::Abandoned) {
+            fprintf(stderr, "Shared memory segment %s was abandoned by its publisher, removing it\n", name.c_str());
+            removeAbandoned(name, fd);
+        }
+        close(fd);
+        if(state == State::Ready) {
+            printf("Mapped %s from shared memory segment %s\n", filename.c_str(), name.c_str());
+            return true;
+        }
+        else if(state == State::Invalid) {
+            break;
+        }
+    }
+    fprintf(stderr, "Shared memory segment %s is not usable, parsing %s\n", name.c_str(), filename.c_str());
+    return SNNBench::loadWmat(filename, matrix);
+}
+} // SharedConnectivity
+} // SNNBench
@@ -0,0 +1,71 @@
+#pragma once
+
+// Standard C++ includes
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SNNBENCH_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::SIMD
+//------------------------------------------------------------------------
+//! Runtime choice between the scalar, AVX2 and AVX-512 code paths of the
+//! native kernels. The vector paths are compiled with target attributes so
+//! no -march flag is needed and the binary runs on any x86-64 CPU
+namespace SIMD
+{
+enum class ISA
+{
+    Scalar,
+    AVX2,
+    AVX512,
+};
+
+//! Widest instruction set this CPU supports
+inline ISA detect()
+{
+#ifdef SNNBENCH_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) {
+        return ISA::AVX512;
+    }
+    else if(__builtin_cpu_supports("avx2")) {
+        return ISA::AVX2;
+    }
+#endif
+    return ISA::Scalar;
+}
+
+inline const char *getName(ISA isa)
+{
+    switch(isa) {
+    case ISA::AVX2:
+        return "avx2";
+    case ISA::AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+//! Parse "scalar", "avx2", "avx512" or "auto", never choosing more than the CPU supports
+inline ISA select(const std::string &name)
+{
+    const ISA best = detect();
+    ISA isa = best;
+    if(name == "scalar") {
+        isa = ISA::Scalar;
+    }
+    else if(name == "avx2") {
+        isa = ISA::AVX2;
+    }
+    else if(name == "avx512") {
+        isa = ISA::AVX512;
+    }
+    return ((int)isa <= (int)best) ? isa : best;
+}
+} // SIMD
+} // SNNBench
@@ -0,0 +1,176 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Benchmark runner utilities
+#include "../_runner/machine.h"
+#include "../_runner/process.h"
+
+// Shared benchmark utilities
+#include "shared_connectivity.h"
+
+namespace SNNBench {
+namespace SynapseGroups {
+//------------------------------------------------------------------------
+// SNNBench::SynapseGroups::Split
+//------------------------------------------------------------------------
+//! How a .wmat projection divides between synapse groups when its lines
+//! are dealt out round-robin (as Brunel10K's connect_from_mat does by
+//! shortening the delay of line n by n % numGroups timesteps). Within a
+//! step, every synapse of a group onto the same postsynaptic neuron adds
+//! to that neuron's input atomically, so the per-group in-degree bounds
+//! how many of those adds can collide. Shorter delays also lower the
+//! largest timestep grouping Spike can use
+struct Split
+{
+    unsigned int numGroups;
+    unsigned int minDelaySteps;
+    double meanInDegree;
+    unsigned int maxInDegree;
+};
+
+//------------------------------------------------------------------------
+// SNNBench::SynapseGroups::Calibration
+//------------------------------------------------------------------------
+struct Calibration
+{
+    unsigned int numGroups;
+    double stepSeconds;
+    Split split;
+};
+
+//------------------------------------------------------------------------
+// Free functions
+//------------------------------------------------------------------------
+//! Split counts worth calibrating: powers of two that leave each group a
+//! delay of at least one timestep
+inline std::vector<unsigned int> getCandidates(unsigned int delaySteps)
+{
+    std::vector<unsigned int> candidates;
+    for(unsigned int n = 1; n <= 8 && n < delaySteps; n *= 2) {
+        candidates.push_back(n);
+    }
+    return candidates;
+}
+
+//! Hash of a connectivity file's contents, or an empty string if it can't
+//! be read
+inline std::string getConnectivityHash(const std::string &filename)
+{
+    return SharedConnectivity::getFileHash(filename);
+}
+
+//! Per-group in-degrees of filename's postsynaptic neurons for each split
+//! count of a projection with a delay of delaySteps timesteps
+inline std::vector<Split> getSplits(const std::string &filename, unsigned int delaySteps,
+                                    const std::vector<unsigned int> &candidates)
+{
+    std::ifstream stream(filename);
+    std::string line;
+    std::vector<unsigned int> posts;
+    int lineCount = 0;
+    unsigned int numPost = 0;
+    while(std::getline(stream, line)) {
+        if(line.empty() || line[0] == '%') {
+            continue;
+        }
+        // Numbered as connect_from_mat does, counting the header as line 1
+        lineCount++;
+        if(lineCount == 1) {
+            continue;
+        }
+        int pre, post;
+        std::istringstream(line) >> pre >> post;
+        posts.push_back((unsigned int)(post - 1));
+        numPost = std::max(numPost, (unsigned int)post);
+    }
+
+    std::vector<Split> splits;
+    for(unsigned int n : candidates) {
+        std::vector<unsigned int> inDegree((size_t)numPost * n, 0);
+        for(size_t i = 0; i < posts.size(); i++) {
+            const unsigned int group = (unsigned int)((i + 2) % n);
+            inDegree[((size_t)group * numPost) + posts[i]]++;
+        }
+        const double meanInDegree = inDegree.empty() ? 0.0 : (double)posts.size() / (double)inDegree.size();
+        const unsigned int maxInDegree = inDegree.empty() ? 0 : *std::max_element(inDegree.begin(), inDegree.end());
+        splits.push_back({n, delaySteps - (n - 1), meanInDegree, maxInDegree});
+    }
+    return splits;
+}
+
+//! Split count cached for key on this machine, or 0 if there is none
+inline unsigned int readCache(const std::string &filename, const std::string &key)
+{
+    const std::string machine = Machine::getFingerprint(Machine::getDescription());
+    std::ifstream stream(filename);
+    std::string line;
+    unsigned int numGroups = 0;
+    while(std::getline(stream, line)) {
+        std::istringstream ss(line);
+        std::string lineMachine, lineKey;
+        unsigned int lineGroups;
+        if((ss >> lineMachine >> lineKey >> lineGroups) && lineMachine == machine && lineKey == key) {
+            numGroups = lineGroups;
+        }
+    }
+    return numGroups;
+}
+
+inline void writeCache(const std::string &filename, const std::string &key, unsigned int numGroups)
+{
+    std::ofstream stream(filename, std::ios::app);
+    stream << Machine::getFingerprint(Machine::getDescription()) << " " << key << " " << numGroups << std::endl;
+}
+
+//! Time each candidate split count by running command (this benchmark in
+//! --fast mode for a short simtime, without --num_synapse_groups) as a
+//! child process and reading back its timefile.dat. Logs every candidate
+//! with the per-group in-degrees behind it and returns the count with the
+//! shortest step time, or 0 if no calibration run succeeded
+inline unsigned int calibrate(const std::string &command, const std::vector<Split> &splits, unsigned int numSteps)
+{
+    std::vector<Calibration> calibrations;
+    for(const Split &s : splits) {
+        printf("Calibrating %u synapse group(s)...\n", s.numGroups);
+        double simSeconds = 0.0;
+        const Process::Result result = Process::run(".", command + " --num_synapse_groups " + std::to_string(s.numGroups),
+                                                    {}, true);
+        if(!result.succeeded() || !Process::readNumber("timefile.dat", simSeconds)) {
+            printf("  calibration run failed (exit status %d)\n", result.exitStatus);
+            continue;
+        }
+        calibrations.push_back({s.numGroups, simSeconds / (double)numSteps, s});
+    }
+    if(calibrations.empty()) {
+        return 0;
+    }
+
+    const Calibration &best = *std::min_element(calibrations.begin(), calibrations.end(),
+                                                [](const Calibration &a, const Calibration &b){ return a.stepSeconds < b.stepSeconds; });
+    const Calibration &reference = calibrations.front();
+    printf("%8s %12s %14s %14s %10s\n", "groups", "step [us]", "mean in-degree", "max in-degree", "min delay");
+    for(const Calibration &c : calibrations) {
+        printf("%8u %12.2f %14.2f %14u %10u%s\n", c.numGroups, c.stepSeconds * 1.0e6, c.split.meanInDegree,
+               c.split.maxInDegree, c.split.minDelaySteps, (&c == &best) ? " <- chosen" : "");
+    }
+    if(best.numGroups == reference.numGroups) {
+        printf("Keeping %u synapse group(s): splitting further lowered the per-group in-degree but not the step time, "
+               "so the extra per-group work and shorter minimum delay outweighed any reduction in atomic contention\n", best.numGroups);
+    }
+    else {
+        printf("Using %u synapse groups: %.1f%% faster per step than %u, with at most %u rather than %u synapses "
+               "of a group adding to one postsynaptic neuron (less atomic contention per group)\n",
+               best.numGroups, 100.0 * (1.0 - (best.stepSeconds / reference.stepSeconds)), reference.numGroups,
+               best.split.maxInDegree, reference.split.maxInDegree);
+    }
+    return best.numGroups;
+}
+} // SynapseGroups
+} // SNNBench
@@ -0,0 +1,166 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::ThreadPool
+//------------------------------------------------------------------------
+//! Persistent worker threads for the native engines. A simulation step
+//! dispatches a few short parallel loops, so rather than sleeping on a
+//! condition variable the workers spin (yielding to the OS after a while)
+//! waiting for the next one. The calling thread always takes part as
+//! thread 0, so a pool of one thread has no workers at all
+class ThreadPool
+{
+public:
+    ThreadPool(unsigned int numThreads)
+    :   m_NumThreads(std::max(1u, numThreads)), m_Generation(0), m_Remaining(0), m_Task(nullptr), m_Context(nullptr),
+        m_Quit(false)
+    {
+        startWorkers();
+    }
+
+    ~ThreadPool()
+    {
+        stopWorkers();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool &operator=(const ThreadPool&) = delete;
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    unsigned int getNumThreads() const{ return m_NumThreads; }
+
+    //! Join the worker threads, which a forked child would not inherit. No
+    //! loops may be dispatched until startWorkers is called, in this
+    //! process or in a child forked from it
+    void stopWorkers()
+    {
+        m_Quit.store(true, std::memory_order_release);
+        m_Generation.fetch_add(1, std::memory_order_acq_rel);
+        for(auto &w : m_Workers) {
+            w.join();
+        }
+        m_Workers.clear();
+        m_Quit.store(false, std::memory_order_release);
+    }
+
+    //! (Re)start the worker threads if they are not running
+    void startWorkers()
+    {
+        if(m_Workers.empty()) {
+            const unsigned int generation = m_Generation.load(std::memory_order_acquire);
+            for(unsigned int t = 1; t < m_NumThreads; t++) {
+                m_Workers.emplace_back(&ThreadPool::workerLoop, this, t, generation);
+            }
+        }
+    }
+
+    //! Split [0, count) into one contiguous chunk per thread and call
+    //! fn(begin, end, thread) on each, returning once all have finished.
+    //! Chunk boundaries are rounded to multiples of align
+    template<typename F>
+    void parallelFor(unsigned int count, F fn, unsigned int align = 1)
+    {
+        const unsigned int numThreads = m_NumThreads;
+        auto chunk = [count, numThreads, align, &fn](unsigned int thread)
+        {
+            const unsigned int begin = getChunkBoundary(count, numThreads, align, thread);
+            const unsigned int end = getChunkBoundary(count, numThreads, align, thread + 1);
+            fn(begin, end, thread);
+        };
+        run(chunk);
+    }
+
+    //! Call fn(thread) once on every thread, returning once all have finished
+    template<typename F>
+    void run(F &&fn)
+    {
+        typedef typename std::remove_reference<F>::type Function;
+
+        if(m_NumThreads == 1) {
+            fn(0);
+            return;
+        }
+
+        m_Task = &invoke<Function>;
+        m_Context = const_cast<void*>(static_cast<const void*>(&fn));
+        m_Remaining.store(m_NumThreads - 1, std::memory_order_relaxed);
+        m_Generation.fetch_add(1, std::memory_order_release);
+
+        fn(0);
+
+        for(unsigned int spin = 0; m_Remaining.load(std::memory_order_acquire) != 0; spin++) {
+            if(spin > SpinsBeforeYield) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    //! First index of thread's chunk when count items are split across
+    //! numThreads, keeping boundaries on multiples of align
+    static unsigned int getChunkBoundary(unsigned int count, unsigned int numThreads, unsigned int align,
+                                         unsigned int thread)
+    {
+        const unsigned int numBlocks = (count + align - 1) / align;
+        const unsigned int block = (unsigned int)(((unsigned long long)numBlocks * thread) / numThreads);
+        return std::min(count, block * align);
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    template<typename F>
+    static void invoke(void *context, unsigned int thread)
+    {
+        (*static_cast<F*>(context))(thread);
+    }
+
+    void workerLoop(unsigned int thread, unsigned int seen)
+    {
+        while(true) {
+            // Wait for the next dispatch
+            unsigned int generation;
+            for(unsigned int spin = 0; (generation = m_Generation.load(std::memory_order_acquire)) == seen; spin++) {
+                if(spin > SpinsBeforeYield) {
+                    std::this_thread::yield();
+                }
+            }
+            seen = generation;
+
+            if(m_Quit.load(std::memory_order_acquire)) {
+                return;
+            }
+
+            m_Task(m_Context, thread);
+            m_Remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Static constants
+    //------------------------------------------------------------------------
+    static constexpr unsigned int SpinsBeforeYield = 2000;
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const unsigned int m_NumThreads;
+    std::vector<std::thread> m_Workers;
+
+    std::atomic<unsigned int> m_Generation;
+    std::atomic<unsigned int> m_Remaining;
+    void (*m_Task)(void*, unsigned int);
+    void *m_Context;
+    std::atomic<bool> m_Quit;
+};
+} // SNNBench
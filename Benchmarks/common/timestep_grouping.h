@@ -0,0 +1,87 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+// Shared benchmark utilities
+#include "trace.h"
+
+namespace SNNBench {
+namespace TimestepGrouping {
+//------------------------------------------------------------------------
+// SNNBench::TimestepGrouping::Calibration
+//------------------------------------------------------------------------
+//! Fastest wall-clock time of a calibration burst at one group size
+struct Calibration
+{
+    int groupSize;
+    double seconds;
+};
+
+//------------------------------------------------------------------------
+// Free functions
+//------------------------------------------------------------------------
+//! Group sizes worth calibrating: powers of two below the largest legal
+//! size (the minimum synaptic delay in timesteps) and that size itself
+inline std::vector<int> getCandidates(int maxGroupSize)
+{
+    std::vector<int> candidates;
+    for(int g = 1; g < maxGroupSize; g *= 2) {
+        candidates.push_back(g);
+    }
+    candidates.push_back(std::max(1, maxGroupSize));
+    return candidates;
+}
+
+//! Pick the timestep grouping of a Spike SpikingModel by running bursts of
+//! burst seconds at each candidate group size, rounds times in
+//! interleaved order so drifting clocks or thermals favour no candidate.
+//! Must be called after finalise_model, when timestep_grouping holds the
+//! largest legal group size. The model is reset afterwards so the full
+//! run starts from the same state as an untuned one. reset_state isn't
+//! known to restore synaptic efficacies, so plastic models mustn't be tuned
+template<typename M>
+int tune(M *model, float burst, unsigned int rounds = 2)
+{
+    const int maxGroupSize = model->timestep_grouping;
+    const std::vector<int> candidates = getCandidates(maxGroupSize);
+    if(candidates.size() == 1) {
+        printf("Timestep grouping: minimum delay allows only a group size of %d\n", candidates.front());
+        return candidates.front();
+    }
+
+    Trace::Scope trace("Tune timestep grouping");
+    std::vector<Calibration> calibrations;
+    for(int g : candidates) {
+        calibrations.push_back({g, std::numeric_limits<double>::max()});
+    }
+
+    // First burst absorbs one-off costs such as kernel loading and allocation
+    model->run(burst);
+    for(unsigned int r = 0; r < rounds; r++) {
+        for(Calibration &c : calibrations) {
+            model->timestep_grouping = c.groupSize;
+            const auto start = std::chrono::steady_clock::now();
+            model->run(burst);
+            const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+            c.seconds = std::min(c.seconds, duration.count());
+        }
+    }
+
+    const Calibration &best = *std::min_element(calibrations.begin(), calibrations.end(),
+                                                [](const Calibration &a, const Calibration &b){ return a.seconds < b.seconds; });
+    printf("Timestep grouping calibration (%gs bursts, best of %u):\n", burst, rounds);
+    for(const Calibration &c : calibrations) {
+        printf("  group size %2d: %.4fs%s\n", c.groupSize, c.seconds, (&c == &best) ? " <- chosen" : "");
+    }
+
+    model->reset_state();
+    model->timestep_grouping = best.groupSize;
+    return best.groupSize;
+}
+} // TimestepGrouping
+} // SNNBench
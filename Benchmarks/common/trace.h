@@ -0,0 +1,273 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SNNBench {
+namespace Trace {
+//------------------------------------------------------------------------
+// SNNBench::Trace::Event
+//------------------------------------------------------------------------
+//! A single completed scope - begin and end timestamps in microseconds
+struct Event
+{
+    const char *name;
+    const char *category;
+    double begin;
+    double end;
+};
+
+//------------------------------------------------------------------------
+// SNNBench::Trace::ThreadBuffer
+//------------------------------------------------------------------------
+//! Fixed-size ring of events owned by a single thread. Once full, the
+//! oldest events are overwritten so tracing never allocates mid-run
+class ThreadBuffer
+{
+public:
+    ThreadBuffer(unsigned int threadID, bool main, size_t capacity)
+    : m_ThreadID(threadID), m_Main(main), m_Events(capacity), m_Head(0), m_Count(0)
+    {}
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    void push(const char *name, const char *category, double begin, double end)
+    {
+        m_Events[m_Head] = {name, category, begin, end};
+        m_Head = (m_Head + 1) % m_Events.size();
+        if(m_Count < m_Events.size()) {
+            m_Count++;
+        }
+        else {
+            m_Dropped++;
+        }
+    }
+
+    unsigned int getThreadID() const{ return m_ThreadID; }
+    bool isMain() const{ return m_Main; }
+    size_t getDropped() const{ return m_Dropped; }
+
+    //! Call visitor with each buffered event, oldest first
+    template<typename V>
+    void forEach(V visitor) const
+    {
+        const size_t first = (m_Head + m_Events.size() - m_Count) % m_Events.size();
+        for(size_t i = 0; i < m_Count; i++) {
+            visitor(m_Events[(first + i) % m_Events.size()]);
+        }
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const unsigned int m_ThreadID;
+    const bool m_Main;
+    std::vector<Event> m_Events;
+    size_t m_Head;
+    size_t m_Count;
+    size_t m_Dropped = 0;
+};
+
+//------------------------------------------------------------------------
+// SNNBench::Trace::Recorder
+//------------------------------------------------------------------------
+//! Process-wide trace state. Disabled by default; when enabled, every
+//! thread lazily registers its own ring buffer and the whole trace is
+//! written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) at exit
+class Recorder
+{
+public:
+    static Recorder &getInstance()
+    {
+        static Recorder recorder;
+        return recorder;
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Start tracing, writing filename when the process exits
+    void enable(const std::string &filename = "trace.json", size_t eventsPerThread = 1 << 16)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if(!m_Enabled.load()) {
+            m_Filename = filename;
+            m_EventsPerThread = eventsPerThread;
+            m_MainThread = std::this_thread::get_id();
+            m_Enabled = true;
+            std::atexit([](){ getInstance().flush(); });
+        }
+    }
+
+    bool isEnabled() const{ return m_Enabled.load(std::memory_order_relaxed); }
+
+    //! Microseconds since the recorder was created
+    double now() const
+    {
+        const std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - m_Start;
+        return duration.count();
+    }
+
+    void record(const char *name, const char *category, double begin, double end)
+    {
+        getThreadBuffer().push(name, category, begin, end);
+    }
+
+    //! Write all buffered events; called automatically at exit once enabled
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if(!m_Enabled.load() || m_Buffers.empty()) {
+            return;
+        }
+
+        std::ofstream stream(m_Filename);
+        stream.precision(3);
+        stream << std::fixed << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+
+        bool first = true;
+        size_t dropped = 0;
+        for(const auto &buffer : m_Buffers) {
+            const unsigned int tid = buffer->getThreadID();
+            writeSeparator(stream, first);
+            stream << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << tid
+                << ", \"args\": {\"name\": \"" << (buffer->isMain() ? "main" : "worker " + std::to_string(tid)) << "\"}}";
+
+            buffer->forEach([&stream, &first, tid](const Event &e)
+                            {
+                                writeSeparator(stream, first);
+                                stream << "{\"name\": \"" << e.name << "\", \"cat\": \"" << e.category
+                                    << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << tid
+                                    << ", \"ts\": " << e.begin << ", \"dur\": " << (e.end - e.begin) << "}";
+                            });
+            dropped += buffer->getDropped();
+        }
+        stream << std::endl << "]}" << std::endl;
+
+        printf("Trace written to %s", m_Filename.c_str());
+        if(dropped > 0) {
+            printf(" (%zu oldest events overwritten)", dropped);
+        }
+        printf("\n");
+        m_Enabled = false;
+    }
+
+private:
+    Recorder() : m_Start(std::chrono::steady_clock::now()), m_Enabled(false), m_EventsPerThread(0)
+    {}
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    ThreadBuffer &getThreadBuffer()
+    {
+        thread_local ThreadBuffer *buffer = nullptr;
+        if(buffer == nullptr) {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Buffers.emplace_back(new ThreadBuffer((unsigned int)m_Buffers.size(),
+                                                 std::this_thread::get_id() == m_MainThread,
+                                                 m_EventsPerThread));
+            buffer = m_Buffers.back().get();
+        }
+        return *buffer;
+    }
+
+    static void writeSeparator(std::ofstream &stream, bool &first)
+    {
+        if(!first) {
+            stream << "," << std::endl;
+        }
+        first = false;
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const std::chrono::steady_clock::time_point m_Start;
+    std::atomic<bool> m_Enabled;
+    std::mutex m_Mutex;
+    std::string m_Filename;
+    size_t m_EventsPerThread;
+    std::thread::id m_MainThread;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_Buffers;
+};
+
+//------------------------------------------------------------------------
+// SNNBench::Trace::Scope
+//------------------------------------------------------------------------
+//! Records the lifetime of this object as one trace event. Name and
+//! category must be string literals (or otherwise outlive the trace).
+//! Costs a single branch when tracing is disabled
+class Scope
+{
+public:
+    Scope(const char *name, const char *category = "setup", bool active = true)
+    : m_Name(name), m_Category(category), m_Active(active && Recorder::getInstance().isEnabled()),
+      m_Begin(m_Active ? Recorder::getInstance().now() : 0.0)
+    {}
+
+    ~Scope()
+    {
+        if(m_Active) {
+            Recorder &recorder = Recorder::getInstance();
+            recorder.record(m_Name, m_Category, m_Begin, recorder.now());
+        }
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const char *m_Name;
+    const char *m_Category;
+    const bool m_Active;
+    const double m_Begin;
+};
+
+//------------------------------------------------------------------------
+// Free functions
+//------------------------------------------------------------------------
+inline void enable(const std::string &filename = "trace.json")
+{
+    Recorder::getInstance().enable(filename);
+}
+
+//! True if simulation step should be traced given a --trace_every interval
+inline bool shouldTraceStep(unsigned int step, unsigned int every)
+{
+    return (every > 0) && ((step % every) == 0);
+}
+
+//! Run a model which advances via run(seconds), e.g. a Spike SpikingModel.
+//! With a non-zero interval the run is split into chunks of that many
+//! timesteps, each recorded as a trace event
+template<typename M>
+void runModel(M *model, float simtime, float timestep, unsigned int every)
+{
+    if(every == 0) {
+        model->run(simtime);
+        return;
+    }
+
+    const unsigned long totalSteps = (unsigned long)std::round(simtime / timestep);
+    for(unsigned long step = 0; step < totalSteps; step += every) {
+        const unsigned long chunkSteps = std::min<unsigned long>(every, totalSteps - step);
+        Scope chunk("Steps", "simulation");
+        model->run(chunkSteps * timestep);
+    }
+}
+} // Trace
+} // SNNBench
@@ -0,0 +1,97 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Shared benchmark utilities
+#include "philox.h"
+
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::VAConnectivity
+//------------------------------------------------------------------------
+//! Procedural Vogels-Abbott connectivity at any network scale. Neuron
+//! counts grow with the scale while the connection probability shrinks
+//! by the same factor (as in sim_coba_benchmark.cpp) so the in-degree
+//! stays constant. Rows are produced in memory, one presynaptic neuron
+//! at a time, so no connectivity file is ever written
+namespace VAConnectivity
+{
+//! Projections, numbered as in Auryn's network.N.0.wmat output files
+enum class Projection
+{
+    EE = 0,
+    EI = 1,
+    IE = 2,
+    II = 3,
+};
+
+//------------------------------------------------------------------------
+// SNNBench::VAConnectivity::Spec
+//------------------------------------------------------------------------
+struct Spec
+{
+    unsigned int numPre;
+    unsigned int numPost;
+    double probability;
+    float weight;   // [g_leak], as in the .wmat files
+};
+
+inline Spec getSpec(Projection projection, unsigned int scale)
+{
+    const unsigned int numExcitatory = 3200 * scale;
+    const unsigned int numInhibitory = 800 * scale;
+    const double probability = 0.02 / (double)scale;
+
+    switch(projection) {
+    case Projection::EE:
+        return {numExcitatory, numExcitatory, probability, 0.4f};
+    case Projection::EI:
+        return {numExcitatory, numInhibitory, probability, 0.4f};
+    case Projection::IE:
+        return {numInhibitory, numExcitatory, probability, 5.1f};
+    default:
+        return {numInhibitory, numInhibitory, probability, 5.1f};
+    }
+}
+
+//! Row length which a binomial(numPost, probability) row exceeds with
+//! negligible probability - used to size fixed-stride ragged matrices
+inline unsigned int getMaxRowLength(unsigned int numPost, double probability)
+{
+    const double mean = (double)numPost * probability;
+    const double sd = std::sqrt(mean * (1.0 - probability));
+    return std::min(numPost, (unsigned int)std::ceil(mean + (7.0 * sd) + 8.0));
+}
+
+//! Generate every row of a projection, calling rowFn(pre, postIndices)
+//! with sorted postsynaptic indices. Row pre draws from Philox stream
+//! (seed, projection, pre) so the result is independent of the order
+//! rows are consumed in
+template<typename F>
+void generateRows(Projection projection, unsigned int scale, unsigned int seed, F rowFn)
+{
+    const Spec spec = getSpec(projection, scale);
+    const double logNotP = std::log(1.0 - spec.probability);
+
+    std::vector<unsigned int> row;
+    row.reserve(getMaxRowLength(spec.numPost, spec.probability));
+    for(unsigned int pre = 0; pre < spec.numPre; pre++) {
+        Philox::Stream rng(seed, (uint32_t)projection, pre);
+
+        // Skip geometrically distributed gaps between connections
+        row.clear();
+        for(double post = -1.0;;) {
+            post += 1.0 + std::floor(std::log(rng.nextUniformDouble()) / logNotP);
+            if(post >= (double)spec.numPost) {
+                break;
+            }
+            row.push_back((unsigned int)post);
+        }
+        rowFn(pre, row);
+    }
+}
+} // VAConnectivity
+} // SNNBench
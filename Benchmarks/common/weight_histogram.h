@@ -0,0 +1,351 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Shared benchmark utilities
+#include "simd.h"
+#include "thread_pool.h"
+#include "trace.h"
+
+namespace SNNBench {
+namespace WeightHistogram {
+using SIMD::ISA;
+
+//------------------------------------------------------------------------
+// SNNBench::WeightHistogram::Binning
+//------------------------------------------------------------------------
+//! numBins equal bins spanning [wMin, wMax]. Weights outside it are
+//! counted in the first or last bin, which min and max then show
+struct Binning
+{
+    Binning(float wMin, float wMax, unsigned int numBins)
+    :   wMin(wMin), wMax(wMax), numBins(std::max(1u, numBins)), scale((float)this->numBins / (wMax - wMin))
+    {
+    }
+
+    unsigned int getBin(float w) const
+    {
+        const float f = (w - wMin) * scale;
+        return (f > 0.0f) ? std::min(numBins - 1, (unsigned int)f) : 0;
+    }
+
+    float wMin;
+    float wMax;
+    unsigned int numBins;
+    float scale;
+};
+
+//------------------------------------------------------------------------
+// SNNBench::WeightHistogram::Summary
+//------------------------------------------------------------------------
+//! Bin counts and moments of some weights, which can be merged with others
+//! of the same shift. The moments are sums of each weight less shift,
+//! which is chosen close to the mean so the variance doesn't come from the
+//! difference of two nearly equal numbers
+struct Summary
+{
+    void reset(unsigned int numBins, float shift)
+    {
+        counts.assign(numBins, 0);
+        count = 0;
+        this->shift = shift;
+        sum = 0.0;
+        sumSq = 0.0;
+        min = std::numeric_limits<float>::max();
+        max = std::numeric_limits<float>::lowest();
+    }
+
+    void merge(const Summary &other)
+    {
+        for(size_t b = 0; b < counts.size(); b++) {
+            counts[b] += other.counts[b];
+        }
+        count += other.count;
+        sum += other.sum;
+        sumSq += other.sumSq;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    double getMean() const{ return (count > 0) ? ((double)shift + (sum / (double)count)) : 0.0; }
+
+    double getVariance() const
+    {
+        const double shiftedMean = (count > 0) ? (sum / (double)count) : 0.0;
+        return (count > 0) ? std::max(0.0, (sumSq / (double)count) - (shiftedMean * shiftedMean)) : 0.0;
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t count;
+    float shift;
+    double sum;
+    double sumSq;
+    float min;
+    float max;
+};
+
+//------------------------------------------------------------------------
+// Scalar kernel
+//------------------------------------------------------------------------
+inline void accumulateScalar(const Binning &binning, const float *weights, size_t begin, size_t end, Summary &summary)
+{
+    for(size_t i = begin; i < end; i++) {
+        const float w = weights[i];
+        const double d = (double)w - (double)summary.shift;
+        summary.counts[binning.getBin(w)]++;
+        summary.sum += d;
+        summary.sumSq += d * d;
+        summary.min = std::min(summary.min, w);
+        summary.max = std::max(summary.max, w);
+    }
+    summary.count += end - begin;
+}
+
+#ifdef SNNBENCH_X86_SIMD
+//------------------------------------------------------------------------
+// Vector kernels
+//------------------------------------------------------------------------
+// Lanes of the vector kernels' sums are only moved into the double totals
+// every block, so float rounding stays small whatever the weight count
+static const size_t SumBlockLength = 1024;
+
+__attribute__((target("avx2")))
+inline float horizontalSumAVX2(__m256 v)
+{
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, v);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+//! Bin 8 weights at a time; the bin counts themselves stay scalar, as
+//! lanes falling in the same bin would conflict
+__attribute__((target("avx2")))
+inline void accumulateAVX2(const Binning &binning, const float *weights, size_t begin, size_t end, Summary &summary)
+{
+    const __m256 wMin = _mm256_set1_ps(binning.wMin);
+    const __m256 scale = _mm256_set1_ps(binning.scale);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 lastBin = _mm256_set1_ps((float)(binning.numBins - 1));
+    const __m256 shift = _mm256_set1_ps(summary.shift);
+    __m256 min = _mm256_set1_ps(summary.min);
+    __m256 max = _mm256_set1_ps(summary.max);
+    alignas(32) int32_t bins[8];
+
+    size_t i = begin;
+    while((i + 8) <= end) {
+        const size_t blockEnd = std::min(end, i + SumBlockLength);
+        __m256 sum = _mm256_setzero_ps();
+        __m256 sumSq = _mm256_setzero_ps();
+        for(; (i + 8) <= blockEnd; i += 8) {
+            const __m256 w = _mm256_loadu_ps(&weights[i]);
+            const __m256 d = _mm256_sub_ps(w, shift);
+            sum = _mm256_add_ps(sum, d);
+            sumSq = _mm256_add_ps(sumSq, _mm256_mul_ps(d, d));
+            min = _mm256_min_ps(min, w);
+            max = _mm256_max_ps(max, w);
+
+            const __m256 f = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(w, wMin), scale), zero), lastBin);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(bins), _mm256_cvttps_epi32(f));
+            for(unsigned int l = 0; l < 8; l++) {
+                summary.counts[bins[l]]++;
+            }
+        }
+        summary.sum += horizontalSumAVX2(sum);
+        summary.sumSq += horizontalSumAVX2(sumSq);
+    }
+    summary.count += i - begin;
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, min);
+    summary.min = *std::min_element(lanes, lanes + 8);
+    _mm256_store_ps(lanes, max);
+    summary.max = *std::max_element(lanes, lanes + 8);
+    accumulateScalar(binning, weights, i, end, summary);
+}
+
+// GCC 12's AVX-512 headers trigger spurious -Wuninitialized warnings here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+inline void accumulateAVX512(const Binning &binning, const float *weights, size_t begin, size_t end, Summary &summary)
+{
+    const __m512 wMin = _mm512_set1_ps(binning.wMin);
+    const __m512 scale = _mm512_set1_ps(binning.scale);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 lastBin = _mm512_set1_ps((float)(binning.numBins - 1));
+    const __m512 shift = _mm512_set1_ps(summary.shift);
+    __m512 min = _mm512_set1_ps(summary.min);
+    __m512 max = _mm512_set1_ps(summary.max);
+    alignas(64) int32_t bins[16];
+
+    size_t i = begin;
+    while((i + 16) <= end) {
+        const size_t blockEnd = std::min(end, i + SumBlockLength);
+        __m512 sum = _mm512_setzero_ps();
+        __m512 sumSq = _mm512_setzero_ps();
+        for(; (i + 16) <= blockEnd; i += 16) {
+            const __m512 w = _mm512_loadu_ps(&weights[i]);
+            const __m512 d = _mm512_sub_ps(w, shift);
+            sum = _mm512_add_ps(sum, d);
+            sumSq = _mm512_fmadd_ps(d, d, sumSq);
+            min = _mm512_min_ps(min, w);
+            max = _mm512_max_ps(max, w);
+
+            const __m512 f = _mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(_mm512_sub_ps(w, wMin), scale), zero), lastBin);
+            _mm512_store_si512(bins, _mm512_cvttps_epi32(f));
+            for(unsigned int l = 0; l < 16; l++) {
+                summary.counts[bins[l]]++;
+            }
+        }
+        summary.sum += _mm512_reduce_add_ps(sum);
+        summary.sumSq += _mm512_reduce_add_ps(sumSq);
+    }
+    summary.count += i - begin;
+    summary.min = _mm512_reduce_min_ps(min);
+    summary.max = _mm512_reduce_max_ps(max);
+    accumulateScalar(binning, weights, i, end, summary);
+}
+#pragma GCC diagnostic pop
+#endif  // SNNBENCH_X86_SIMD
+
+//------------------------------------------------------------------------
+// Dispatch
+//------------------------------------------------------------------------
+inline void accumulate(ISA isa, const Binning &binning, const float *weights, size_t begin, size_t end, Summary &summary)
+{
+#ifdef SNNBENCH_X86_SIMD
+    if(isa == ISA::AVX512) {
+        accumulateAVX512(binning, weights, begin, end, summary);
+        return;
+    }
+    else if(isa == ISA::AVX2) {
+        accumulateAVX2(binning, weights, begin, end, summary);
+        return;
+    }
+#endif
+    accumulateScalar(binning, weights, begin, end, summary);
+}
+
+//------------------------------------------------------------------------
+// SNNBench::WeightHistogram::Logger
+//------------------------------------------------------------------------
+//! Appends the histogram, mean and variance of a projection's weights to
+//! a tab-separated file, one line per call of record, so a long plastic
+//! run can be watched for runaway weights without recording them all.
+//! A run restored from a checkpoint continues an existing file by appending
+class Logger
+{
+public:
+    Logger(const std::string &filename, const Binning &binning, ThreadPool &pool, ISA isa = SIMD::detect(), bool append = false)
+    :   m_Binning(binning), m_Pool(pool), m_ISA(isa), m_Threads(pool.getNumThreads()), m_Shift(0.0f), m_HasShift(false),
+        m_File(fopen(filename.c_str(), append ? "a" : "w"))
+    {
+        m_Total.reset(m_Binning.numBins, 0.0f);
+        if(m_File == nullptr) {
+            perror(filename.c_str());
+            return;
+        }
+        if(append) {
+            return;
+        }
+        fprintf(m_File, "# %u bins of %g between %g and %g\n", m_Binning.numBins,
+                (m_Binning.wMax - m_Binning.wMin) / (float)m_Binning.numBins, m_Binning.wMin, m_Binning.wMax);
+        fprintf(m_File, "time_ms\tmean\tvariance\tmin\tmax");
+        for(unsigned int b = 0; b < m_Binning.numBins; b++) {
+            fprintf(m_File, "\tbin%u", b);
+        }
+        fprintf(m_File, "\n");
+    }
+
+    ~Logger()
+    {
+        if(m_File != nullptr) {
+            fclose(m_File);
+        }
+    }
+
+    Logger(const Logger&) = delete;
+    Logger &operator=(const Logger&) = delete;
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    bool isOpen() const{ return m_File != nullptr; }
+
+    //! Flush the log, so a checkpoint can record its size
+    bool flush(){ return (m_File != nullptr) && (fflush(m_File) == 0); }
+
+    //! Get the shift the next record will use, the mean of the last one,
+    //! returning false if there hasn't been one. A restored run sets it
+    //! so its records are rounded exactly as an uninterrupted run's
+    bool getShift(float &shift) const
+    {
+        shift = m_Shift;
+        return m_HasShift;
+    }
+
+    void setShift(float shift)
+    {
+        m_Shift = shift;
+        m_HasShift = true;
+    }
+
+    //! Bin count weights across the pool's threads and log them at time
+    const Summary &record(double time, const float *weights, size_t count)
+    {
+        Trace::Scope trace("Weight histogram", "recording");
+
+        // Shift by the last mean, or any weight the first time
+        const float shift = m_HasShift ? m_Shift : ((count > 0) ? weights[0] : 0.0f);
+        for(auto &t : m_Threads) {
+            t.reset(m_Binning.numBins, shift);
+        }
+        m_Pool.parallelFor((unsigned int)count,
+            [this, weights](unsigned int begin, unsigned int end, unsigned int thread)
+            {
+                accumulate(m_ISA, m_Binning, weights, begin, end, m_Threads[thread]);
+            }, 16);
+
+        m_Total.reset(m_Binning.numBins, shift);
+        for(const auto &t : m_Threads) {
+            m_Total.merge(t);
+        }
+        if(m_Total.count > 0) {
+            setShift((float)m_Total.getMean());
+        }
+
+        if(m_File != nullptr) {
+            fprintf(m_File, "%.10g\t%.10g\t%.10g\t%.10g\t%.10g", time, m_Total.getMean(), m_Total.getVariance(),
+                    (count > 0) ? m_Total.min : 0.0f, (count > 0) ? m_Total.max : 0.0f);
+            for(uint64_t c : m_Total.counts) {
+                fprintf(m_File, "\t%llu", (unsigned long long)c);
+            }
+            fprintf(m_File, "\n");
+            fflush(m_File);
+        }
+        return m_Total;
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const Binning m_Binning;
+    ThreadPool &m_Pool;
+    const ISA m_ISA;
+    std::vector<Summary> m_Threads;
+    Summary m_Total;
+    float m_Shift;
+    bool m_HasShift;
+    FILE *m_File;
+};
+} // WeightHistogram
+} // SNNBench
@@ -0,0 +1,311 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX includes
+#include <time.h>
+
+// Shared benchmark utilities
+#include "trace.h"
+
+//------------------------------------------------------------------------
+// Append-only stream of weight snapshots. After a header, each snapshot
+// is a record header and one block of every weight:
+//
+//   "SNNBWMON" | version (uint64) | numWeights (uint64)
+//   step (uint64) | kind (uint32) | quantum (float32) | payload   (repeated)
+//
+// A Full record's payload is numWeights float32 weights. A Delta record's
+// is numWeights int16 steps of quantum from the weights reconstructed from
+// the previous record, as ref[i] += (float)delta[i] * quantum, so
+// quantisation errors don't accumulate. A stream starts with a Full record
+// and has one every KeyFrameInterval records (and wherever it was appended
+// to without restoring the monitor's state), so it can be read from any of them
+//------------------------------------------------------------------------
+namespace SNNBench {
+//------------------------------------------------------------------------
+// SNNBench::WeightMonitor
+//------------------------------------------------------------------------
+//! Writes weight snapshots from a background thread, so the simulation
+//! only pays for copying the weights. A snapshot taken while the previous
+//! one is still being written waits for it to finish
+class WeightMonitor
+{
+public:
+    enum class Encoding
+    {
+        Full,
+        Delta,
+    };
+
+    enum class Kind : uint32_t
+    {
+        Full = 0,
+        Delta = 1,
+    };
+
+    WeightMonitor(const std::string &filename, size_t numWeights, Encoding encoding, bool append = false)
+    :   m_Filename(filename), m_NumWeights(numWeights), m_Encoding(encoding), m_File(nullptr), m_Good(false),
+        m_NumBytes(0), m_NumRecords(0), m_WriterCPUSeconds(0.0), m_HasPending(false), m_Writing(false), m_PendingStep(0), m_Stop(false)
+    {
+        m_File = fopen(filename.c_str(), append ? "a+b" : "wb");
+        if(m_File == nullptr) {
+            perror(filename.c_str());
+            return;
+        }
+        m_Good = writeOrCheckHeader();
+        if(!m_Good) {
+            fprintf(stderr, "%s is not a weight stream of %zu weights\n", filename.c_str(), numWeights);
+            return;
+        }
+        m_Pending.resize(numWeights);
+        m_Thread = std::thread(&WeightMonitor::writerLoop, this);
+    }
+
+    ~WeightMonitor()
+    {
+        finish();
+    }
+
+    WeightMonitor(const WeightMonitor&) = delete;
+    WeightMonitor &operator=(const WeightMonitor&) = delete;
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    bool isOpen() const{ return m_Good; }
+
+    //! Snapshot the numWeights weights as they are after step
+    void record(unsigned long long step, const float *weights)
+    {
+        if(!m_Good) {
+            return;
+        }
+        Trace::Scope trace("Snapshot weights", "recording");
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this](){ return !m_HasPending; });
+        std::copy(weights, weights + m_NumWeights, m_Pending.begin());
+        m_PendingStep = step;
+        m_HasPending = true;
+        m_Condition.notify_all();
+    }
+
+    //! Wait for every snapshot recorded so far to be written and flush the
+    //! stream, so a checkpoint can record its size. Returns false if
+    //! anything failed to write
+    bool flush()
+    {
+        if(!m_Good) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this](){ return !m_HasPending && !m_Writing; });
+        if(fflush(m_File) != 0) {
+            perror(m_Filename.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    //! Number of records written and the weights the next Delta record is
+    //! relative to, which a checkpoint saves after flush so a restored run
+    //! continues the stream exactly as an uninterrupted one would
+    unsigned long long getNumRecords() const{ return m_NumRecords; }
+    const std::vector<float> &getReference() const{ return m_Reference; }
+
+    //! Restore the state of the run that wrote the stream being appended
+    //! to, before anything is recorded
+    void setState(unsigned long long numRecords, const std::vector<float> &reference)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_NumRecords = numRecords;
+        m_Reference = reference;
+    }
+
+    //! Write any outstanding snapshot and close the stream, returning false
+    //! if anything failed to write
+    bool finish()
+    {
+        if(m_Thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Stop = true;
+            }
+            m_Condition.notify_all();
+            m_Thread.join();
+        }
+        if(m_File != nullptr) {
+            m_Good = (fclose(m_File) == 0) && m_Good;
+            m_File = nullptr;
+            if(!m_Good) {
+                perror(m_Filename.c_str());
+            }
+        }
+        return m_Good;
+    }
+
+    //! Bytes written so far
+    size_t getNumBytes() const{ return m_NumBytes.load(); }
+
+    //! CPU time the writer thread used, which clock() would count as the
+    //! simulation's. Only complete once finish has returned
+    double getWriterCPUSeconds() const{ return m_WriterCPUSeconds; }
+
+    //------------------------------------------------------------------------
+    // Static constants
+    //------------------------------------------------------------------------
+    static const unsigned int KeyFrameInterval = 16;
+
+private:
+    //------------------------------------------------------------------------
+    // Constants
+    //------------------------------------------------------------------------
+    static constexpr const char *Magic = "SNNBWMON";
+    static const uint64_t Version = 1;
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    //! Start a new stream or, when appending, check the existing one holds
+    //! the same number of weights
+    bool writeOrCheckHeader()
+    {
+        if(fseek(m_File, 0, SEEK_END) != 0) {
+            return false;
+        }
+        const long size = ftell(m_File);
+        const uint64_t header[2] = {Version, (uint64_t)m_NumWeights};
+        if(size == 0) {
+            return put(Magic, 8) && put(header, sizeof(header));
+        }
+
+        char magic[8];
+        uint64_t existing[2];
+        rewind(m_File);
+        const bool valid = (fread(magic, 1, 8, m_File) == 8) && (memcmp(magic, Magic, 8) == 0)
+            && (fread(existing, sizeof(uint64_t), 2, m_File) == 2) && (memcmp(existing, header, sizeof(header)) == 0);
+        return valid && (fseek(m_File, 0, SEEK_END) == 0);
+    }
+
+    bool put(const void *data, size_t bytes)
+    {
+        m_NumBytes += bytes;
+        return fwrite(data, 1, bytes, m_File) == bytes;
+    }
+
+    //! Encode and write each snapshot handed over by record until finish
+    void writerLoop()
+    {
+        std::vector<float> weights(m_NumWeights);
+        std::vector<int16_t> deltas;
+        bool good = true;
+        while(true) {
+            unsigned long long step;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this](){ return m_HasPending || m_Stop; });
+                if(!m_HasPending) {
+                    break;
+                }
+                weights.swap(m_Pending);
+                step = m_PendingStep;
+                m_HasPending = false;
+                m_Writing = true;
+            }
+            m_Condition.notify_all();
+
+            const bool keyFrame = (m_Encoding == Encoding::Full) || ((m_NumRecords % KeyFrameInterval) == 0)
+                || (m_Reference.size() != m_NumWeights);
+            float quantum = 0.0f;
+            if(!keyFrame) {
+                quantum = getDeltas(weights, m_Reference, deltas);
+            }
+
+            const Kind kind = keyFrame ? Kind::Full : Kind::Delta;
+            good = good && put(&step, sizeof(uint64_t)) && put(&kind, sizeof(Kind)) && put(&quantum, sizeof(float));
+            if(keyFrame) {
+                good = good && put(weights.data(), weights.size() * sizeof(float));
+                if(m_Encoding == Encoding::Delta) {
+                    m_Reference = weights;
+                }
+            }
+            else {
+                good = good && put(deltas.data(), deltas.size() * sizeof(int16_t));
+            }
+            m_NumRecords++;
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Writing = false;
+            }
+            m_Condition.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Good = good && (fflush(m_File) == 0);
+
+        timespec cpuTime;
+        if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime) == 0) {
+            m_WriterCPUSeconds = (double)cpuTime.tv_sec + ((double)cpuTime.tv_nsec * 1.0E-9);
+        }
+    }
+
+    //! Quantise the change from reference to weights into deltas, in steps
+    //! of the quantum returned, and advance reference by what they encode
+    static float getDeltas(const std::vector<float> &weights, std::vector<float> &reference, std::vector<int16_t> &deltas)
+    {
+        float maxChange = 0.0f;
+        for(size_t i = 0; i < weights.size(); i++) {
+            maxChange = std::max(maxChange, std::fabs(weights[i] - reference[i]));
+        }
+        deltas.resize(weights.size());
+        if(maxChange == 0.0f) {
+            std::fill(deltas.begin(), deltas.end(), 0);
+            return 0.0f;
+        }
+
+        const float quantum = maxChange / 32767.0f;
+        const float scale = 32767.0f / maxChange;
+        for(size_t i = 0; i < weights.size(); i++) {
+            const float q = std::nearbyint((weights[i] - reference[i]) * scale);
+            deltas[i] = (int16_t)std::max(-32767.0f, std::min(32767.0f, q));
+            reference[i] += (float)deltas[i] * quantum;
+        }
+        return quantum;
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const std::string m_Filename;
+    const size_t m_NumWeights;
+    const Encoding m_Encoding;
+    FILE *m_File;
+    bool m_Good;
+    std::atomic<size_t> m_NumBytes;
+    unsigned long long m_NumRecords;
+    std::vector<float> m_Reference;
+    double m_WriterCPUSeconds;
+
+    // Snapshot handed from record to the writer thread
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::vector<float> m_Pending;
+    bool m_HasPending;
+    bool m_Writing;
+    unsigned long long m_PendingStep;
+    bool m_Stop;
+    std::thread m_Thread;
+};
+} // SNNBench